@@ -0,0 +1,156 @@
+#include "batchplayout.h"
+
+#include <bitset>
+
+// Small and fast generator (splitmix64) for the shuffles of the batch, seeded
+// from the caller's engine. drawing from default_random_engine through
+// uniform_int_distribution costs more than the whole batched connection check
+class CFastRandom {
+   private:
+    uint64_t state;
+
+   public:
+    CFastRandom(TRandomEngine& seed_engine)
+        : state((uint64_t(seed_engine()) << 32) ^ seed_engine()) {}
+
+    uint64_t Next(void) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return (z ^ (z >> 31));
+    }
+
+    // uniform in [0, range), Lemire's multiply and reject, which only
+    // divides in the rare case of a possibly biased draw
+    uint32_t Below(const uint32_t range) {
+        uint64_t m = (Next() >> 32) * range;
+        uint32_t low = uint32_t(m);
+
+        if (low < range) {
+            const uint32_t threshold = uint32_t(-range) % range;
+            while (low < threshold) {
+                m = (Next() >> 32) * range;
+                low = uint32_t(m);
+            }
+        }
+        return (uint32_t(m >> 32));
+    }
+};
+
+int32_t CBatchPlayout::Run(const CBitBoard& position,
+                           const TVectorIDList& empty_cells,
+                           const int32_t candidate_inx,
+                           const EVertextColor mover, int32_t sim_count,
+                           TRandomEngine& random_engine,
+                           CPlayoutCounters& counters, const bool timing) {
+    const int32_t width = position.Width();
+    int32_t winner_count = 0;
+
+    // rest of the empty places as bit positions
+    fill_bits.clear();
+    for (int32_t i = 0; i != static_cast<int32_t>(empty_cells.size()); i++) {
+        if (i != candidate_inx) {
+            fill_bits.push_back(position.BitIndex(empty_cells[i]));
+        }
+    }
+
+    const int32_t fill_count = static_cast<int32_t>(fill_bits.size());
+
+    // the opponent moves first after the candidate, so the mover gets the
+    // smaller half of the rest
+    const int32_t mover_count = fill_count / 2;
+
+    TBitBoardBits base = position.Bits(mover);
+    SetBoardBit(base, position.BitIndex(empty_cells[candidate_inx]));
+
+    CFastRandom fast_random(random_engine);
+
+    counters.playouts += sim_count;
+
+    while (sim_count > 0) {
+        const int32_t lanes = min(sim_count, BatchSize);
+        CPhaseClock clock(timing);
+
+        for (int32_t y = 0; y < width; y++) {
+            for (int32_t l = 0; l < BatchSize; l++) {
+                stones[y][l] = (l < lanes) ? base[y] : 0u;
+            }
+        }
+        clock.Lap(counters.reset_time);
+
+        // partial Fisher-Yates shuffle per lane, only the mover's part
+        for (int32_t l = 0; l < lanes; l++) {
+            for (int32_t i = 0; i < mover_count; i++) {
+                swap(fill_bits[i],
+                     fill_bits[i + fast_random.Below(fill_count - i)]);
+                stones[fill_bits[i] >> 5][l] |= 1u << (fill_bits[i] & 31);
+            }
+        }
+        clock.Lap(counters.fill_time);
+
+        winner_count += static_cast<int32_t>(
+            bitset<BatchSize>(Connects(width, mover)).count());
+        clock.Lap(counters.detect_time);
+        sim_count -= lanes;
+    }
+
+    return (winner_count);
+}
+
+uint64_t CBatchPlayout::Connects(const int32_t width, const EVertextColor c) {
+    const uint32_t right_column = 1u << (width - 1);
+    const bool red = (c == EVertextColor::vtRED);
+
+    // seed from the first edge of the color: left column for red, top row
+    // for blue
+    for (int32_t y = 0; y < width; y++) {
+        const uint32_t seed_mask = red ? 1u : (y == 0 ? ~0u : 0u);
+        for (int32_t l = 0; l < BatchSize; l++) {
+            reached[y][l] = FillRow(stones[y][l] & seed_mask, stones[y][l]);
+        }
+    }
+
+    // sweep downwards and upwards until no lane changes anymore
+    uint32_t changed = 1;
+    while (changed) {
+        changed = 0;
+
+        for (int32_t y = 1; y < width; y++) {
+            for (int32_t l = 0; l < BatchSize; l++) {
+                uint32_t above = reached[y - 1][l];
+                uint32_t seed = (above | (above >> 1)) & stones[y][l];
+                uint32_t row = FillRow(reached[y][l] | seed, stones[y][l]);
+                changed |= row ^ reached[y][l];
+                reached[y][l] = row;
+            }
+        }
+
+        for (int32_t y = width - 2; y >= 0; y--) {
+            for (int32_t l = 0; l < BatchSize; l++) {
+                uint32_t below = reached[y + 1][l];
+                uint32_t seed = (below | (below << 1)) & stones[y][l];
+                uint32_t row = FillRow(reached[y][l] | seed, stones[y][l]);
+                changed |= row ^ reached[y][l];
+                reached[y][l] = row;
+            }
+        }
+    }
+
+    // red has to arrive at the right column, blue at the bottom row
+    uint64_t winners = 0;
+    for (int32_t l = 0; l < BatchSize; l++) {
+        uint32_t arrived = 0;
+
+        if (red) {
+            for (int32_t y = 0; y < width; y++) {
+                arrived |= reached[y][l] & right_column;
+            }
+        } else {
+            arrived = reached[width - 1][l];
+        }
+
+        winners |= uint64_t(arrived != 0) << l;
+    }
+
+    return (winners);
+}
@@ -0,0 +1,50 @@
+#ifndef BATCHPLAYOUT_H
+#define BATCHPLAYOUT_H
+
+#include <cstdint>  // for platform independent types
+#include <random>
+#include <vector>
+using namespace std;
+
+#include "bitboard.h"
+#include "telemetry.h"
+
+typedef vector<TVertexID> TVectorIDList;
+typedef default_random_engine TRandomEngine;
+
+// Batch of full fill playouts of the same position, checked for a connection
+// all at once.
+//
+// The rows of BatchSize boards are stored lane by lane, so row y of every
+// board is one contiguous array. The flood fill then does each step of
+// CBitBoard::Connects() for all lanes in one loop without branches, which
+// the compiler turns into SIMD code, 8 lanes per AVX2 and 16 per AVX-512
+// instruction. Lanes whose fill has settled keep running until the last one
+// has, which costs less than the branches would.
+class CBatchPlayout {
+   public:
+    static const int32_t BatchSize = 64;
+
+   private:
+    typedef uint32_t TBatchRows[HEX_MAX_BOARD_WIDTH][BatchSize];
+
+    TBatchRows stones;
+    TBatchRows reached;
+
+    // scratch list of bit positions, kept to avoid allocations per call
+    vector<int32_t> fill_bits;
+
+    // bit l is set if the stones of lane l connect the edges of c
+    uint64_t Connects(const int32_t width, const EVertextColor c);
+
+   public:
+    // same as CPlayout::Run() in full fill mode, sim_count playouts are
+    // played in batches of BatchSize. the work is added to counters, phase
+    // times only if timing is set
+    int32_t Run(const CBitBoard& position, const TVectorIDList& empty_cells,
+                const int32_t candidate_inx, const EVertextColor mover,
+                int32_t sim_count, TRandomEngine& random_engine,
+                CPlayoutCounters& counters, const bool timing = false);
+};
+
+#endif
@@ -0,0 +1,350 @@
+// Benchmarks of the engine hot paths.
+//
+// Every case runs with a fixed seed, so two runs measure the same work. The
+// results go to stdout as CSV, one line per case:
+//
+//   group,case,iterations,seconds,rate,unit
+//
+// rate is how many units were done per second. Build it next to the game,
+// from the repository root:
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/hexbench.cpp $(ls *.cpp | grep -v
+//   main.cpp) -o hexbench
+//
+// Options:
+//   --filter=TEXT   only run the cases whose group or name contains TEXT
+//   --time=MS       minimum measuring time per case, 300 by default
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+using namespace std;
+using namespace chrono;
+
+#include "connectivity.h"
+#include "graph.h"
+#include "graphcsr.h"
+#include "playout.h"
+#include "shortestpath.h"
+#include "threadpool.h"
+
+static string case_filter;
+static double min_seconds = 0.3;
+
+// runs body(iterations) with a growing iteration count until it takes at
+// least min_seconds, then prints units_per_iteration * iterations per second.
+// one untimed iteration first warms up caches and the allocator
+static void Measure(const string& group, const string& name,
+                    const string& unit, const double units_per_iteration,
+                    const function<void(const int64_t)>& body) {
+    if (!case_filter.empty() &&
+        ((group + "/" + name).find(case_filter) == string::npos)) {
+        return;
+    }
+
+    int64_t iterations = 1;
+    double seconds = 0.0;
+
+    body(1);
+
+    for (;;) {
+        steady_clock::time_point start = steady_clock::now();
+        body(iterations);
+        seconds = duration<double>(steady_clock::now() - start).count();
+
+        if ((seconds >= min_seconds) || (iterations >= (int64_t(1) << 40))) {
+            break;
+        }
+
+        // aim a bit above the minimum, at most ten times as many
+        iterations *= (seconds > 0.0)
+                          ? min<int64_t>(10, int64_t(1.2 * min_seconds /
+                                                     seconds) + 1)
+                          : 10;
+    }
+
+    cout << group << "," << name << "," << iterations << "," << seconds << ","
+         << units_per_iteration * iterations / seconds << "," << unit << endl;
+}
+
+// board graph with the vertex layout of CHexBoard, see connectivity.h
+static void BuildBoardGraph(CGraph& g, const int32_t w) {
+    for (int32_t i = 0; i < w * w; i++) {
+        (void)g.AddVertex();
+    }
+
+    TWeightedEdges edges;
+    for (int32_t y = 0; y < w; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            const TVertexID v = y * w + x;
+
+            if (x + 1 < w) {
+                edges.push_back(CWeightedEdge(v, v + 1, 1.0f));
+            }
+            if ((y + 1 < w) && (x > 0)) {
+                edges.push_back(CWeightedEdge(v, v + w - 1, 1.0f));
+            }
+            if (y + 1 < w) {
+                edges.push_back(CWeightedEdge(v, v + w, 1.0f));
+            }
+        }
+    }
+
+    const TVertexID left = g.AddVertex(EVertextColor::vtRED);
+    const TVertexID right = g.AddVertex(EVertextColor::vtRED);
+    const TVertexID top = g.AddVertex(EVertextColor::vtBLUE);
+    const TVertexID bottom = g.AddVertex(EVertextColor::vtBLUE);
+
+    for (int32_t i = 0; i < w; i++) {
+        edges.push_back(CWeightedEdge(left, i * w, 1.0f));
+        edges.push_back(CWeightedEdge(right, (i + 1) * w - 1, 1.0f));
+        edges.push_back(CWeightedEdge(top, i, 1.0f));
+        edges.push_back(CWeightedEdge(bottom, i + (w - 1) * w, 1.0f));
+    }
+
+    g.AddEdges(edges);
+}
+
+// random position with fill_percent of the cells taken, alternately by red
+// and blue
+static void RandomPosition(const int32_t w, const int32_t fill_percent,
+                           mt19937& rng, CBitBoard& board,
+                           TVectorIDList& empty_cells) {
+    TVectorIDList cells;
+    for (int32_t i = 0; i < w * w; i++) {
+        cells.push_back(i);
+    }
+    shuffle(cells.begin(), cells.end(), rng);
+
+    const int32_t taken = w * w * fill_percent / 100;
+    board = CBitBoard(w);
+    for (int32_t i = 0; i < taken; i++) {
+        board.Set(cells[i], (i % 2) ? EVertextColor::vtBLUE
+                                    : EVertextColor::vtRED);
+    }
+
+    empty_cells.assign(cells.begin() + taken, cells.end());
+    sort(empty_cells.begin(), empty_cells.end());
+}
+
+static void PlayoutBenchmarks() {
+    const int32_t sim_count = 256;
+    const pair<EPlayoutMode, string> modes[] = {
+        {EPlayoutMode::pmFULL_FILL, "full"},
+        {EPlayoutMode::pmEARLY_STOP, "early"},
+        {EPlayoutMode::pmBATCH, "batch"}};
+
+    for (const int32_t w : {7, 11, 13, 19}) {
+        for (const int32_t fill : {0, 25, 50, 75}) {
+            mt19937 rng(w * 100 + fill);
+            CBitBoard board;
+            TVectorIDList empty_cells;
+            RandomPosition(w, fill, rng, board, empty_cells);
+
+            for (const pair<EPlayoutMode, string>& m : modes) {
+                CPlayout playout(m.first);
+                TRandomEngine random_engine(1);
+
+                Measure("playout",
+                        m.second + "_" + to_string(w) + "x" + to_string(w) +
+                            "_fill" + to_string(fill),
+                        "playouts", sim_count, [&](const int64_t n) {
+                            for (int64_t i = 0; i < n; i++) {
+                                playout.Run(board, empty_cells, 0,
+                                            EVertextColor::vtRED, sim_count,
+                                            random_engine);
+                            }
+                        });
+            }
+        }
+    }
+}
+
+static void ShortestPathBenchmarks() {
+    // winning path on filled boards, as PrintBoard() searches it
+    for (const int32_t w : {7, 11, 13, 19}) {
+        mt19937 rng(w);
+        CGraph g;
+        BuildBoardGraph(g, w);
+
+        for (int32_t i = 0; i < w * w; i++) {
+            g.GetVertex(i).Color =
+                (rng() % 2) ? EVertextColor::vtRED : EVertextColor::vtBLUE;
+        }
+
+        CShortestPath sp(g);
+        const TVertexID left = HexEdgeVertex(w, EHexEdge::heLEFT);
+        const TVertexID right = HexEdgeVertex(w, EHexEdge::heRIGHT);
+        const TVertexID top = HexEdgeVertex(w, EHexEdge::heTOP);
+        const TVertexID bottom = HexEdgeVertex(w, EHexEdge::heBOTTOM);
+
+        Measure("dijkstra", "board_" + to_string(w) + "x" + to_string(w),
+                "queries", 2, [&](const int64_t n) {
+                    for (int64_t i = 0; i < n; i++) {
+                        sp.DijkstraShortestPath(left, right);
+                        sp.DijkstraShortestPath(top, bottom);
+                    }
+                });
+    }
+
+    // random point to point queries, one weight per edge from 1 to 10
+    const pair<uint32_t, float> sizes[] = {{1000, 0.01f}, {10000, 0.001f}};
+    for (const pair<uint32_t, float>& size : sizes) {
+        CGraph g(size.first, size.second, 7);
+        CShortestPath sp(g);
+        const string name = "random_" + to_string(size.first);
+        const int32_t query_count = 64;
+
+        mt19937 rng(11);
+        vector<pair<TVertexID, TVertexID>> queries;
+        for (int32_t i = 0; i < query_count; i++) {
+            queries.push_back(
+                make_pair(rng() % size.first, rng() % size.first));
+        }
+
+        Measure("dijkstra", name, "queries", query_count, [&](const int64_t n) {
+            for (int64_t i = 0; i < n; i++) {
+                for (const pair<TVertexID, TVertexID>& q : queries) {
+                    sp.DijkstraShortestPath(q.first, q.second);
+                }
+            }
+        });
+        Measure("bidirectional", name, "queries", query_count,
+                [&](const int64_t n) {
+                    for (int64_t i = 0; i < n; i++) {
+                        for (const pair<TVertexID, TVertexID>& q : queries) {
+                            sp.BidirectionalShortestPath(q.first, q.second);
+                        }
+                    }
+                });
+    }
+}
+
+// sparse graph with about five edges per vertex
+static void RandomSparseGraph(CGraph& g, const uint32_t vertex_count,
+                              const uint32_t seed) {
+    mt19937 rng(seed);
+    uniform_real_distribution<float> weight(1.0f, 10.0f);
+    TWeightedEdges edges;
+
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        (void)g.AddVertex();
+    }
+    for (uint32_t i = 0; i < vertex_count * 5; i++) {
+        edges.push_back(CWeightedEdge(rng() % vertex_count,
+                                      rng() % vertex_count, weight(rng)));
+    }
+    g.AddEdges(edges);
+}
+
+static void SpanningTreeBenchmarks() {
+    CThreadPool pool;
+
+    for (const uint32_t vertex_count : {10000u, 100000u}) {
+        CGraph g;
+        RandomSparseGraph(g, vertex_count, 3);
+        CShortestPath sp(g);
+        const string name = "sparse_" + to_string(vertex_count);
+
+        Measure("kruskal", name, "edges", g.NumberOfEdges(),
+                [&](const int64_t n) {
+                    for (int64_t i = 0; i < n; i++) {
+                        sp.KruskalMinimalSpanningTree();
+                    }
+                });
+        Measure("boruvka", name, "edges", g.NumberOfEdges(),
+                [&](const int64_t n) {
+                    for (int64_t i = 0; i < n; i++) {
+                        sp.BoruvkaMinimalSpanningTree(pool);
+                    }
+                });
+    }
+}
+
+static void ConstructionBenchmarks() {
+    for (const int32_t w : {11, 19}) {
+        Measure("construct", "board_" + to_string(w) + "x" + to_string(w),
+                "graphs", 1, [&](const int64_t n) {
+                    for (int64_t i = 0; i < n; i++) {
+                        CGraph g;
+                        BuildBoardGraph(g, w);
+                    }
+                });
+    }
+
+    Measure("construct", "random_2000_0.05", "graphs", 1, [](const int64_t n) {
+        for (int64_t i = 0; i < n; i++) {
+            CGraph g(2000, 0.05f, 5);
+        }
+    });
+
+    // text and binary file of the same graph
+    const string text_file = "hexbench_graph.txt";
+    const string binary_file = "hexbench_graph.bin";
+    const uint32_t vertex_count = 100000;
+    {
+        CGraph g;
+        RandomSparseGraph(g, vertex_count, 9);
+
+        ofstream out(text_file);
+        out << vertex_count << "\n";
+        for (const CEdge& e : g.EdgeList()) {
+            out << e.From().ID() << " " << e.To().ID() << " " << e.Value()
+                << "\n";
+        }
+        out.close();
+
+        CGraphCSR(text_file).Save(binary_file);
+    }
+
+    const double edge_count = vertex_count * 5;
+    Measure("load", "cgraph_text_100000", "edges", edge_count,
+            [&](const int64_t n) {
+                for (int64_t i = 0; i < n; i++) {
+                    CGraph g(text_file);
+                }
+            });
+    Measure("load", "csr_text_100000", "edges", edge_count,
+            [&](const int64_t n) {
+                for (int64_t i = 0; i < n; i++) {
+                    CGraphCSR csr(text_file);
+                }
+            });
+    Measure("load", "csr_binary_100000", "edges", edge_count,
+            [&](const int64_t n) {
+                for (int64_t i = 0; i < n; i++) {
+                    CGraphCSR csr(binary_file);
+                }
+            });
+
+    remove(text_file.c_str());
+    remove(binary_file.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.compare(0, 9, "--filter=") == 0) {
+            case_filter = arg.substr(9);
+        } else if (arg.compare(0, 7, "--time=") == 0) {
+            min_seconds = atoi(arg.substr(7).c_str()) / 1000.0;
+        } else {
+            cerr << "usage: hexbench [--filter=TEXT] [--time=MS]\n";
+            return (1);
+        }
+    }
+
+    cout << "group,case,iterations,seconds,rate,unit" << endl;
+
+    PlayoutBenchmarks();
+    ShortestPathBenchmarks();
+    SpanningTreeBenchmarks();
+    ConstructionBenchmarks();
+
+    return (0);
+}
@@ -0,0 +1,229 @@
+// Brute force check of the inferior cell analysis (see inferior.h).
+//
+// Two properties are checked on every board of 3x3 and on random positions
+// of bigger boards, near their edges and corners too:
+//
+//   fill     giving the captured cells to their capturer changes the winner
+//            of no way to fill the empty cells
+//   minimax  a game tree which only tries the moves of SelectCandidateMoves()
+//            has the same value as the full tree, so pruning never throws
+//            away the only winning moves
+//
+// Build it next to the game, from the repository root:
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/inferiorcheck.cpp $(ls *.cpp |
+//   grep -v main.cpp) -o inferiorcheck
+//
+// Options:
+//   --positions=N   random positions per board size, 2000 by default
+//   --seed=N        seed of the random positions, 1 by default
+//
+// Prints the checked positions and any mismatch, and exits with 1 if there
+// was one.
+
+#include <algorithm>
+#include <cstdint>  // for platform independent types
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+#include "bitboard.h"
+#include "inferior.h"
+
+static int64_t mismatches = 0;
+
+static EVertextColor Winner(const CBitBoard& b) {
+    if (b.IsWinner(EVertextColor::vtRED)) return (EVertextColor::vtRED);
+    if (b.IsWinner(EVertextColor::vtBLUE)) return (EVertextColor::vtBLUE);
+    return (EVertextColor::vtWHITE);
+}
+
+static void EmptyCells(const CBitBoard& b, TVectorIDList& empty_cells) {
+    empty_cells.clear();
+    for (TVertexID id = 0; id < b.Width() * b.Width(); id++) {
+        if (b.Get(id) == EVertextColor::vtWHITE) {
+            empty_cells.push_back(id);
+        }
+    }
+}
+
+static void Report(const string& check, const CBitBoard& b) {
+    mismatches++;
+    cout << check << " mismatch on " << b.Width() << "x" << b.Width() << ":";
+    for (TVertexID id = 0; id < b.Width() * b.Width(); id++) {
+        cout << (id % b.Width() ? "" : " ")
+             << ".br"[static_cast<int>(b.Get(id))];
+    }
+    cout << endl;
+}
+
+// every fill of the empty cells has the same winner with the captured cells
+// given to their capturer
+static void CheckFill(const CBitBoard& position) {
+    CBitBoard filled = position;
+    (void)FillCapturedCells(filled);
+
+    TVectorIDList empty_cells;
+    EmptyCells(position, empty_cells);
+
+    for (uint32_t bits = 0; bits < (1u << empty_cells.size()); bits++) {
+        CBitBoard fill = position;
+        CBitBoard captured_fill = position;
+
+        for (size_t i = 0; i < empty_cells.size(); i++) {
+            const TVertexID id = empty_cells[i];
+            const EVertextColor c = (bits & (1u << i))
+                                        ? EVertextColor::vtRED
+                                        : EVertextColor::vtBLUE;
+            fill.Set(id, c);
+            captured_fill.Set(id, filled.Get(id) == EVertextColor::vtWHITE
+                                      ? c
+                                      : filled.Get(id));
+        }
+
+        if (Winner(fill) != Winner(captured_fill)) {
+            Report("fill", position);
+            return;
+        }
+    }
+}
+
+// true if the player to move wins, trying all moves or only the candidates
+static bool ToMoveWins(CBitBoard& b, const EVertextColor to_move,
+                       const bool prune,
+                       unordered_map<uint64_t, bool>& memo) {
+    const EVertextColor opponent = OpponentColor(to_move);
+    if (b.IsWinner(opponent)) {
+        return (false);
+    }
+
+    const uint64_t key =
+        b.Hash() ^ (to_move == EVertextColor::vtRED ? 0x5555555555555555ull : 0);
+    auto known = memo.find(key);
+    if (known != memo.end()) {
+        return (known->second);
+    }
+
+    TVectorIDList empty_cells;
+    EmptyCells(b, empty_cells);
+
+    TVectorIDList moves;
+    if (prune) {
+        SelectCandidateMoves(b, empty_cells, true, moves);
+    } else {
+        for (int32_t i = 0; i < static_cast<int32_t>(empty_cells.size()); i++) {
+            moves.push_back(i);
+        }
+    }
+
+    bool wins = false;
+    for (const TVertexID i : moves) {
+        b.Set(empty_cells[i], to_move);
+        wins = !ToMoveWins(b, opponent, prune, memo);
+        b.Set(empty_cells[i], EVertextColor::vtWHITE);
+
+        if (wins) break;
+    }
+
+    memo[key] = wins;
+    return (wins);
+}
+
+static void CheckMinimax(const CBitBoard& position,
+                         const EVertextColor to_move) {
+    unordered_map<uint64_t, bool> full_memo;
+    unordered_map<uint64_t, bool> pruned_memo;
+    CBitBoard b = position;
+
+    if (ToMoveWins(b, to_move, false, full_memo) !=
+        ToMoveWins(b, to_move, true, pruned_memo)) {
+        Report("minimax", position);
+    }
+}
+
+// alternating random stones until empty_count cells are left, false if
+// someone has won on the way
+static bool RandomPosition(const int32_t width, const int32_t empty_count,
+                           TRandomEngine& random_engine, CBitBoard& b,
+                           EVertextColor& to_move) {
+    TVectorIDList cells(width * width);
+    for (TVertexID id = 0; id < width * width; id++) {
+        cells[id] = id;
+    }
+    shuffle(cells.begin(), cells.end(), random_engine);
+
+    b = CBitBoard(width);
+    to_move = EVertextColor::vtBLUE;
+    for (int32_t i = 0; i < width * width - empty_count; i++) {
+        b.Set(cells[i], to_move);
+        to_move = OpponentColor(to_move);
+    }
+
+    return (Winner(b) == EVertextColor::vtWHITE);
+}
+
+int main(int argc, char* argv[]) {
+    int32_t positions = 2000;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.compare(0, 12, "--positions=") == 0) {
+            positions = atoi(arg.substr(12).c_str());
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            seed = static_cast<uint32_t>(atoi(arg.substr(7).c_str()));
+        } else {
+            cerr << "usage: inferiorcheck [--positions=N] [--seed=N]\n";
+            return (1);
+        }
+    }
+
+    // every coloring of the 3x3 board, with either player to move
+    int64_t checked = 0;
+    for (int32_t code = 0; code < 19683; code++) {
+        CBitBoard b(3);
+        for (int32_t id = 0, rest = code; id < 9; id++, rest /= 3) {
+            if (rest % 3) {
+                b.Set(id, static_cast<EVertextColor>(rest % 3));
+            }
+        }
+        if (Winner(b) != EVertextColor::vtWHITE) continue;
+
+        CheckFill(b);
+        CheckMinimax(b, EVertextColor::vtRED);
+        CheckMinimax(b, EVertextColor::vtBLUE);
+        checked++;
+    }
+    cout << "3x3: " << checked << " positions" << endl;
+
+    // fills are checked up to 14 empty cells, minimax up to 10
+    TRandomEngine random_engine(seed);
+    for (int32_t width = 4; width <= 7; width++) {
+        checked = 0;
+        for (int32_t i = 0; i < positions; i++) {
+            CBitBoard b;
+            EVertextColor to_move;
+            const int32_t empty_count = 4 + i % 11;
+
+            if (!RandomPosition(width, empty_count, random_engine, b,
+                                to_move)) {
+                continue;
+            }
+
+            CheckFill(b);
+            if (empty_count <= 10) {
+                CheckMinimax(b, to_move);
+            }
+            checked++;
+        }
+        cout << width << "x" << width << ": " << checked << " positions"
+             << endl;
+    }
+
+    cout << mismatches << " mismatches" << endl;
+    return (mismatches ? 1 : 0);
+}
@@ -0,0 +1,114 @@
+// Check that pondering helps the next move of the tree search (see
+// hexboard.h).
+//
+// Headless games on 5x5 to 9x9 boards: the AI plays the move of its tree
+// search, ponders while a random opponent "thinks", and after the
+// opponent's move the next search must start with all the playouts the
+// tree had below the new position:
+//
+//   kept     the tree has playouts below the opponent's move, so pondering
+//            searched the opponent's replies and not the AI's own moves
+//   reused   the AI's next search took these playouts over instead of
+//            starting a new tree
+//
+// Build it next to the game, from the repository root:
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/pondercheck.cpp $(ls *.cpp |
+//   grep -v main.cpp) -o pondercheck
+//
+// Options:
+//   --games=N       games per board size, 4 by default
+//   --seed=N        seed of the games, 1 by default
+//
+// Prints the checked moves and any mismatch, and exits with 1 if there was
+// one.
+
+#include <chrono>
+#include <cstdint>  // for platform independent types
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+using namespace std;
+using namespace std::chrono;
+
+#include "hexboard.h"
+
+static int64_t mismatches = 0;
+
+static void Report(const string& check, const int32_t width,
+                   const int32_t game, const int32_t visits,
+                   const int32_t reused) {
+    mismatches++;
+    cout << check << " mismatch on " << width << "x" << width << " game "
+         << game << ": " << visits << " playouts kept, " << reused
+         << " reused" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int32_t games = 4;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.compare(0, 8, "--games=") == 0) {
+            games = atoi(arg.substr(8).c_str());
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            seed = static_cast<uint32_t>(atoi(arg.substr(7).c_str()));
+        } else {
+            cerr << "usage: pondercheck [--games=N] [--seed=N]\n";
+            return (1);
+        }
+    }
+
+    CSearchSettings settings;
+    settings.engine = ESearchEngine::seMCTS;
+    settings.threads = 1;
+    settings.level = 100;
+    settings.ponder = true;
+    settings.solver_threshold = 0;
+
+    // the random opponent may play dead cells, which a pruned tree lacks
+    settings.prune_inferior = false;
+
+    TRandomEngine random_engine(seed);
+    for (int32_t width = 5; width <= 9; width += 2) {
+        int64_t checked = 0;
+
+        for (int32_t game = 0; game < games; game++) {
+            CHexBoard board(width);
+            board.SetSearchSettings(settings);
+            board.Seed(static_cast<uint32_t>(random_engine()));
+
+            // the AI is blue and moves first. visits is what the tree had
+            // below the position before the AI's search, -1 at the start
+            int32_t visits = -1;
+            for (;;) {
+                const TVertexID move = board.SearchMove(milliseconds(0));
+                if (visits >= 0) {
+                    const int32_t reused = board.ReusedTreeVisits();
+                    if (visits == 0) {
+                        Report("kept", width, game, visits, reused);
+                    } else if (reused != visits) {
+                        Report("reused", width, game, visits, reused);
+                    }
+                    checked++;
+                }
+                if (board.Play(move)) break;
+
+                // the opponent thinks long enough for pondering to finish
+                board.Ponder();
+                this_thread::sleep_for(milliseconds(200));
+
+                const TVectorIDList& empty = board.EmptyCells();
+                if (board.Play(empty[random_engine() % empty.size()])) break;
+                visits = board.TreeVisits();
+            }
+        }
+        cout << width << "x" << width << ": " << checked << " moves" << endl;
+    }
+
+    cout << mismatches << " mismatches" << endl;
+    return (mismatches ? 1 : 0);
+}
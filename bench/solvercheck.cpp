@@ -0,0 +1,178 @@
+// Brute force check of the proof-number solver (see solver.h).
+//
+// Random positions of 3x3 to 5x5 boards are solved and compared with plain
+// minimax, and the move returned for a win must leave the opponent lost.
+// The positions are solved twice:
+//
+//   large    a fresh solver with a big table for every position
+//   small    one solver with a table of a few entries for all positions, so
+//            entries are replaced all the time, as in a long game
+//
+// Build it next to the game, from the repository root:
+//
+//   g++ -std=c++17 -O2 -pthread -I. bench/solvercheck.cpp $(ls *.cpp |
+//   grep -v main.cpp) -o solvercheck
+//
+// Options:
+//   --positions=N   random positions per board size, 1000 by default
+//   --seed=N        seed of the random positions, 1 by default
+//
+// Prints the checked positions and any mismatch, and exits with 1 if there
+// was one.
+
+#include <algorithm>
+#include <cstdint>  // for platform independent types
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+#include "bitboard.h"
+#include "solver.h"
+
+static int64_t mismatches = 0;
+
+static EVertextColor Winner(const CBitBoard& b) {
+    if (b.IsWinner(EVertextColor::vtRED)) return (EVertextColor::vtRED);
+    if (b.IsWinner(EVertextColor::vtBLUE)) return (EVertextColor::vtBLUE);
+    return (EVertextColor::vtWHITE);
+}
+
+static void Report(const string& check, const CBitBoard& b,
+                   const EVertextColor to_move) {
+    mismatches++;
+    cout << check << " mismatch on " << b.Width() << "x" << b.Width() << ":";
+    for (TVertexID id = 0; id < b.Width() * b.Width(); id++) {
+        cout << (id % b.Width() ? "" : " ")
+             << ".br"[static_cast<int>(b.Get(id))];
+    }
+    cout << " " << ".br"[static_cast<int>(to_move)] << " to move" << endl;
+}
+
+// true if the player to move wins
+static bool ToMoveWins(CBitBoard& b, const EVertextColor to_move,
+                       unordered_map<uint64_t, bool>& memo) {
+    const EVertextColor opponent = OpponentColor(to_move);
+    if (b.IsWinner(opponent)) {
+        return (false);
+    }
+
+    const uint64_t key =
+        b.Hash() ^ (to_move == EVertextColor::vtRED ? 0x5555555555555555ull : 0);
+    auto known = memo.find(key);
+    if (known != memo.end()) {
+        return (known->second);
+    }
+
+    bool wins = false;
+    for (TVertexID id = 0; (id < b.Width() * b.Width()) && !wins; id++) {
+        if (b.Get(id) == EVertextColor::vtWHITE) {
+            b.Set(id, to_move);
+            wins = !ToMoveWins(b, opponent, memo);
+            b.Set(id, EVertextColor::vtWHITE);
+        }
+    }
+
+    memo[key] = wins;
+    return (wins);
+}
+
+static void Check(const string& name, CProofNumberSolver& solver,
+                  const CBitBoard& position, const EVertextColor to_move,
+                  unordered_map<uint64_t, bool>& memo) {
+    CBitBoard b = position;
+    const bool wins = ToMoveWins(b, to_move, memo);
+
+    TVertexID move = -1;
+    ESolverResult result = solver.Solve(position, to_move,
+                                        numeric_limits<int64_t>::max(),
+                                        CSearchDeadline(), move);
+
+    if (result != (wins ? ESolverResult::srWIN : ESolverResult::srLOSS)) {
+        Report(name + " result", position, to_move);
+    } else if (wins) {
+        if ((move < 0) || (move >= b.Width() * b.Width()) ||
+            (b.Get(move) != EVertextColor::vtWHITE)) {
+            Report(name + " move", position, to_move);
+            return;
+        }
+
+        b.Set(move, to_move);
+        if (ToMoveWins(b, OpponentColor(to_move), memo)) {
+            Report(name + " move", position, to_move);
+        }
+    }
+}
+
+// alternating random stones until empty_count cells are left, false if
+// someone has won on the way
+static bool RandomPosition(const int32_t width, const int32_t empty_count,
+                           TRandomEngine& random_engine, CBitBoard& b,
+                           EVertextColor& to_move) {
+    TVectorIDList cells(width * width);
+    for (TVertexID id = 0; id < width * width; id++) {
+        cells[id] = id;
+    }
+    shuffle(cells.begin(), cells.end(), random_engine);
+
+    b = CBitBoard(width);
+    to_move = EVertextColor::vtBLUE;
+    for (int32_t i = 0; i < width * width - empty_count; i++) {
+        b.Set(cells[i], to_move);
+        to_move = OpponentColor(to_move);
+    }
+
+    return (Winner(b) == EVertextColor::vtWHITE);
+}
+
+int main(int argc, char* argv[]) {
+    int32_t positions = 1000;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg.compare(0, 12, "--positions=") == 0) {
+            positions = atoi(arg.substr(12).c_str());
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            seed = static_cast<uint32_t>(atoi(arg.substr(7).c_str()));
+        } else {
+            cerr << "usage: solvercheck [--positions=N] [--seed=N]\n";
+            return (1);
+        }
+    }
+
+    TRandomEngine random_engine(seed);
+    CProofNumberSolver small_solver(8);
+
+    // up to 12 empty cells, minimax is too slow beyond
+    for (int32_t width = 3; width <= 5; width++) {
+        int64_t checked = 0;
+        unordered_map<uint64_t, bool> memo;
+
+        for (int32_t i = 0; i < positions; i++) {
+            CBitBoard b;
+            EVertextColor to_move;
+            const int32_t empty_count =
+                min(width * width, 1 + i % 12);
+
+            if (!RandomPosition(width, empty_count, random_engine, b,
+                                to_move)) {
+                continue;
+            }
+
+            CProofNumberSolver large_solver(1 << 16);
+            Check("large", large_solver, b, to_move, memo);
+            Check("small", small_solver, b, to_move, memo);
+            checked++;
+        }
+        cout << width << "x" << width << ": " << checked << " positions"
+             << endl;
+    }
+
+    cout << mismatches << " mismatches" << endl;
+    return (mismatches ? 1 : 0);
+}
@@ -0,0 +1,160 @@
+#include "bitboard.h"
+
+// every cell of the biggest board, by vertex id
+static const int32_t ZOBRIST_CELLS = HEX_MAX_BOARD_WIDTH * HEX_MAX_BOARD_WIDTH;
+
+// keys of red and blue stones, filled once from a fixed seed
+class CZobristTable {
+   public:
+    uint64_t keys[ZOBRIST_CELLS][2];
+
+    CZobristTable() {
+        // splitmix64
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (int32_t i = 0; i < ZOBRIST_CELLS; i++) {
+            for (int32_t c = 0; c < 2; c++) {
+                uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                keys[i][c] = z ^ (z >> 31);
+            }
+        }
+    }
+};
+
+static const CZobristTable zobrist_table;
+
+uint64_t ZobristKey(const TVertexID id, const EVertextColor c) {
+    return (zobrist_table.keys[id][c == EVertextColor::vtRED ? 0 : 1]);
+}
+
+CBitBoard::CBitBoard(const int32_t board_width) : width(board_width) {
+    Clear();
+}
+
+void CBitBoard::Set(const TVertexID id, const EVertextColor c) {
+    const int32_t y = id / width;
+    const uint32_t mask = 1u << (id % width);
+
+    const TVertexID rotated_id = RotatedCell(id);
+
+    if (red_bits[y] & mask) {
+        hash ^= ZobristKey(id, EVertextColor::vtRED);
+        rotated_hash ^= ZobristKey(rotated_id, EVertextColor::vtRED);
+    }
+    if (blue_bits[y] & mask) {
+        hash ^= ZobristKey(id, EVertextColor::vtBLUE);
+        rotated_hash ^= ZobristKey(rotated_id, EVertextColor::vtBLUE);
+    }
+
+    red_bits[y] &= ~mask;
+    blue_bits[y] &= ~mask;
+
+    if (c == EVertextColor::vtRED) {
+        red_bits[y] |= mask;
+    } else if (c == EVertextColor::vtBLUE) {
+        blue_bits[y] |= mask;
+    }
+
+    if (c != EVertextColor::vtWHITE) {
+        hash ^= ZobristKey(id, c);
+        rotated_hash ^= ZobristKey(rotated_id, c);
+    }
+}
+
+EVertextColor CBitBoard::Get(const TVertexID id) const {
+    const int32_t y = id / width;
+    const uint32_t mask = 1u << (id % width);
+
+    if (red_bits[y] & mask) return (EVertextColor::vtRED);
+    if (blue_bits[y] & mask) return (EVertextColor::vtBLUE);
+    return (EVertextColor::vtWHITE);
+}
+
+void CBitBoard::Clear() {
+    red_bits.fill(0);
+    blue_bits.fill(0);
+    hash = 0;
+    rotated_hash = 0;
+}
+
+// reverses the lowest width bits of a row
+static uint32_t MirrorRow(uint32_t row, const int32_t width) {
+    uint32_t result = 0;
+
+    for (int32_t x = 0; x < width; x++) {
+        result = (result << 1) | (row & 1u);
+        row >>= 1;
+    }
+
+    return (result);
+}
+
+bool CBitBoard::IsSymmetric() const {
+    // differing hashes rule out almost every position at once
+    if (hash != rotated_hash) {
+        return (false);
+    }
+
+    for (int32_t y = 0; y < width; y++) {
+        if ((MirrorRow(red_bits[y], width) != red_bits[width - 1 - y]) ||
+            (MirrorRow(blue_bits[y], width) != blue_bits[width - 1 - y])) {
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+bool CBitBoard::Connects(const TBitBoardBits& stones,
+                         const EVertextColor c) const {
+    const uint32_t right_column = 1u << (width - 1);
+    const bool red = (c == EVertextColor::vtRED);
+    TBitBoardBits reached;
+
+    // seed from the first edge of the color: left column for red, top row
+    // for blue
+    for (int32_t y = 0; y < width; y++) {
+        uint32_t seed = red ? (stones[y] & 1u) : (y == 0 ? stones[0] : 0u);
+        reached[y] = seed ? FillRow(seed, stones[y]) : 0u;
+    }
+
+    // sweep downwards and upwards until nothing changes anymore
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (int32_t y = 1; y < width; y++) {
+            uint32_t seed = (reached[y - 1] | (reached[y - 1] >> 1)) &
+                            stones[y] & ~reached[y];
+            if (seed) {
+                reached[y] = FillRow(reached[y] | seed, stones[y]);
+                changed = true;
+            }
+        }
+
+        // blue only has to arrive at the bottom row
+        if (!red && reached[width - 1]) {
+            return (true);
+        }
+
+        for (int32_t y = width - 2; y >= 0; y--) {
+            uint32_t seed = (reached[y + 1] | (reached[y + 1] << 1)) &
+                            stones[y] & ~reached[y];
+            if (seed) {
+                reached[y] = FillRow(reached[y] | seed, stones[y]);
+                changed = true;
+            }
+        }
+    }
+
+    if (red) {
+        for (int32_t y = 0; y < width; y++) {
+            if (reached[y] & right_column) {
+                return (true);
+            }
+        }
+    }
+
+    return (false);
+}
@@ -0,0 +1,143 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>  // for platform independent types
+using namespace std;
+
+#include "graph.h"  // for TVertexID and EVertextColor
+
+// biggest board the packed representation supports (19x19)
+const int32_t HEX_MAX_BOARD_WIDTH = 19;
+
+// random 64 bit key of a stone of color c on cell id, c must be red or blue.
+// a position's hash is the xor of the keys of all its stones. the keys are
+// the same in every run, so hashes can be logged and compared
+uint64_t ZobristKey(const TVertexID id, const EVertextColor c);
+
+// one 32 bit word per board row, bit x of word y is the cell (x, y)
+typedef array<uint32_t, HEX_MAX_BOARD_WIDTH> TBitBoardBits;
+
+// sets the cell addressed by a bit index (see CBitBoard::BitIndex)
+inline void SetBoardBit(TBitBoardBits& bits, const int32_t bit_index) {
+    bits[bit_index >> 5] |= (1u << (bit_index & 31));
+}
+
+// spreads seed bits to both sides along the runs of stones they are part of.
+// Kogge-Stone style fill, so a whole row takes five steps per direction
+inline uint32_t FillRow(uint32_t seed, const uint32_t stones) {
+    uint32_t up = seed;
+    uint32_t down = seed;
+    uint32_t up_pro = stones;
+    uint32_t down_pro = stones;
+
+    up |= up_pro & (up << 1);
+    down |= down_pro & (down >> 1);
+    up_pro &= (up_pro << 1);
+    down_pro &= (down_pro >> 1);
+
+    up |= up_pro & (up << 2);
+    down |= down_pro & (down >> 2);
+    up_pro &= (up_pro << 2);
+    down_pro &= (down_pro >> 2);
+
+    up |= up_pro & (up << 4);
+    down |= down_pro & (down >> 4);
+    up_pro &= (up_pro << 4);
+    down_pro &= (down_pro >> 4);
+
+    up |= up_pro & (up << 8);
+    down |= down_pro & (down >> 8);
+    up_pro &= (up_pro << 8);
+    down_pro &= (down_pro >> 8);
+
+    up |= up_pro & (up << 16);
+    down |= down_pro & (down >> 16);
+
+    return (up | down);
+}
+
+// the other player
+inline EVertextColor OpponentColor(const EVertextColor c) {
+    return (c == EVertextColor::vtRED ? EVertextColor::vtBLUE
+                                      : EVertextColor::vtRED);
+}
+
+// Packed hex position, one bitset per colour.
+//
+// On the board, cell (x, y) touches (x - 1, y) and (x + 1, y) in its own row,
+// (x, y - 1) and (x + 1, y - 1) in the row above and (x - 1, y + 1) and
+// (x, y + 1) in the row below. So moving between rows is a shift of the row
+// word by zero or one bit, and flood fill only needs shifts and masks.
+class CBitBoard {
+   private:
+    int32_t width;
+
+    TBitBoardBits red_bits;
+    TBitBoardBits blue_bits;
+
+    // Zobrist hashes of the stones and of their 180 degree rotation, kept
+    // up to date by Set() and Clear()
+    uint64_t hash;
+    uint64_t rotated_hash;
+
+   public:
+    // constructor, board_width must be between 1 and HEX_MAX_BOARD_WIDTH
+    CBitBoard(const int32_t board_width = 11);
+
+    int32_t Width(void) const { return width; }
+
+    // converts board vertex id (y * width + x) to bit index (y * 32 + x)
+    int32_t BitIndex(const TVertexID id) const {
+        return (((id / width) << 5) + (id % width));
+    }
+
+    const TBitBoardBits& Bits(const EVertextColor c) const {
+        return (c == EVertextColor::vtRED ? red_bits : blue_bits);
+    }
+
+    uint64_t Hash(void) const { return hash; }
+
+    // A hex position plays the same as its 180 degree rotation, which maps
+    // cell (x, y) to (width - 1 - x, width - 1 - y) and keeps the colors
+    // and their edges
+    TVertexID RotatedCell(const TVertexID id) const {
+        return (width * width - 1 - id);
+    }
+
+    // same for a position and its rotation
+    uint64_t CanonicalHash(void) const { return min(hash, rotated_hash); }
+
+    // canonical hash of the position after a stone of c on the empty id
+    uint64_t CanonicalHashAfter(const TVertexID id,
+                                const EVertextColor c) const {
+        return (min(hash ^ ZobristKey(id, c),
+                    rotated_hash ^ ZobristKey(RotatedCell(id), c)));
+    }
+
+    // true if the position equals its rotation, then a move and its rotated
+    // cell are equally good
+    bool IsSymmetric(void) const;
+
+    bool operator==(const CBitBoard& x) const {
+        return ((hash == x.hash) && (width == x.width) &&
+                (red_bits == x.red_bits) &&
+                (blue_bits == x.blue_bits));
+    }
+
+    void Set(const TVertexID id, const EVertextColor c);
+    EVertextColor Get(const TVertexID id) const;
+    void Clear(void);
+
+    // red connects left to right, blue connects top to bottom
+    bool IsWinner(const EVertextColor c) const {
+        return (Connects(Bits(c), c));
+    }
+
+    // checks whether given stones connect the two edges of the color by
+    // shift-and-mask flood fill over the hex neighbourhood
+    bool Connects(const TBitBoardBits& stones, const EVertextColor c) const;
+};
+
+#endif
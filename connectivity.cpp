@@ -0,0 +1,156 @@
+#include "connectivity.h"
+
+#include <cstdlib>
+
+CColorConnectivity::CColorConnectivity(const CGraph& g)
+    : adjacency(make_shared<const CGraphCSR>(g)), groups(g.NumberOfVertices()) {
+    for (const CVertex& v : g.VerticesList()) {
+        colors.push_back(v.Color);
+    }
+
+    JoinColoredVertices();
+}
+
+// hex board adjacency of every supported width, built once
+static shared_ptr<const CGraphCSR> HexAdjacency(const int32_t width) {
+    static const vector<shared_ptr<const CGraphCSR>> all = []() {
+        vector<shared_ptr<const CGraphCSR>> result(HEX_MAX_BOARD_WIDTH + 1);
+
+        for (int32_t w = 1; w <= HEX_MAX_BOARD_WIDTH; w++) {
+            TWeightedEdges edges;
+
+            for (int32_t y = 0; y < w; y++) {
+                for (int32_t x = 0; x < w; x++) {
+                    const TVertexID id = y * w + x;
+
+                    // right, below and below left, the other three
+                    // neighbours come from the cells before
+                    if (x + 1 < w) {
+                        edges.push_back(CWeightedEdge(id, id + 1, 1.0f));
+                    }
+                    if (y + 1 < w) {
+                        edges.push_back(CWeightedEdge(id, id + w, 1.0f));
+                        if (x > 0) {
+                            edges.push_back(
+                                CWeightedEdge(id, id + w - 1, 1.0f));
+                        }
+                    }
+
+                    // virtual edge vertices
+                    if (x == 0) {
+                        edges.push_back(CWeightedEdge(
+                            id, HexEdgeVertex(w, EHexEdge::heLEFT), 1.0f));
+                    }
+                    if (x == w - 1) {
+                        edges.push_back(CWeightedEdge(
+                            id, HexEdgeVertex(w, EHexEdge::heRIGHT), 1.0f));
+                    }
+                    if (y == 0) {
+                        edges.push_back(CWeightedEdge(
+                            id, HexEdgeVertex(w, EHexEdge::heTOP), 1.0f));
+                    }
+                    if (y == w - 1) {
+                        edges.push_back(CWeightedEdge(
+                            id, HexEdgeVertex(w, EHexEdge::heBOTTOM), 1.0f));
+                    }
+                }
+            }
+
+            result[w] = make_shared<const CGraphCSR>(w * w + 4, edges);
+        }
+
+        return (result);
+    }();
+
+    return (all[width]);
+}
+
+CColorConnectivity::CColorConnectivity(const CBitBoard& position)
+    : adjacency(HexAdjacency(position.Width())),
+      groups(position.Width() * position.Width() + 4) {
+    const int32_t cells = position.Width() * position.Width();
+
+    for (TVertexID id = 0; id < cells; id++) {
+        colors.push_back(position.Get(id));
+    }
+    colors.push_back(EVertextColor::vtRED);   // left
+    colors.push_back(EVertextColor::vtRED);   // right
+    colors.push_back(EVertextColor::vtBLUE);  // top
+    colors.push_back(EVertextColor::vtBLUE);  // bottom
+
+    JoinColoredVertices();
+}
+
+// join the vertices which are already colored
+void CColorConnectivity::JoinColoredVertices() {
+    for (TVertexID id = 0; id < static_cast<TVertexID>(colors.size()); id++) {
+        if (colors[id] != EVertextColor::vtWHITE) {
+            for (uint32_t i = adjacency->Begin(id); i != adjacency->End(id);
+                 i++) {
+                if (colors[adjacency->Neighbour(i)] == colors[id]) {
+                    groups.Union(id, adjacency->Neighbour(i));
+                }
+            }
+        }
+    }
+}
+
+TDistanceHeuristic HexDistanceHeuristic(const int32_t width,
+                                        const float min_edge_weight) {
+    const TVertexID cell_count = width * width;
+    const int32_t far = 4 * width;
+
+    // steps from vertex v to the virtual edge vertex e, if e is the first
+    // virtual vertex on the way
+    auto steps_to_edge = [=](const TVertexID v, const TVertexID e) {
+        if (v >= cell_count) {
+            return (v == e ? 0 : far);
+        }
+
+        const int32_t x = v % width;
+        const int32_t y = v / width;
+        switch (static_cast<EHexEdge>(e - cell_count)) {
+            case EHexEdge::heLEFT:
+                return (x + 1);
+            case EHexEdge::heRIGHT:
+                return (width - x);
+            case EHexEdge::heTOP:
+                return (y + 1);
+            default:
+                return (width - y);
+        }
+    };
+
+    return [=](const TVertexID v, const TVertexID target) {
+        int32_t steps = far;
+
+        if ((v < cell_count) && (target < cell_count)) {
+            // cells are neighbours along x, y and the (x - 1, y + 1)
+            // diagonal, which makes these axial coordinates
+            const int32_t dx = target % width - v % width;
+            const int32_t dy = target / width - v / width;
+            steps = max(max(abs(dx), abs(dy)), abs(dx + dy));
+        }
+
+        // a path of one color may also run through the virtual vertices of
+        // that color, which are the left and right or the top and bottom
+        // ones. two of them are at least a whole row apart
+        for (TVertexID first = cell_count; first < cell_count + 4;
+             first += 2) {
+            for (TVertexID e1 = first; e1 < first + 2; e1++) {
+                for (TVertexID e2 = first; e2 < first + 2; e2++) {
+                    steps = min(steps, steps_to_edge(v, e1) +
+                                           (e1 == e2 ? 0 : width + 1) +
+                                           steps_to_edge(target, e2));
+                }
+            }
+        }
+
+        // virtual vertices of different colors, there is no path at all
+        if (steps >= far) {
+            steps = 0;
+        }
+
+        return (steps * min_edge_weight);
+    };
+}
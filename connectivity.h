@@ -0,0 +1,88 @@
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+#include <cstdint>  // for platform independent types
+#include <memory>
+#include <vector>
+using namespace std;
+
+#include "bitboard.h"
+#include "graph.h"
+#include "graphcsr.h"
+#include "shortestpath.h"  // for TDistanceHeuristic
+#include "unionfind.h"
+
+// Vertex layout of a hex board, same as CHexBoard builds its graph: cells
+// y * width + x first, then the virtual edge vertices in this order
+enum class EHexEdge : uint8_t { heLEFT, heRIGHT, heTOP, heBOTTOM };
+
+inline TVertexID HexEdgeVertex(const int32_t width, const EHexEdge e) {
+    return (width * width + static_cast<TVertexID>(e));
+}
+
+// hex distance on a board graph built by CHexBoard, including its virtual
+// edge vertices, which have the colors of their players. min_edge_weight is
+// the lightest edge of the graph
+TDistanceHeuristic HexDistanceHeuristic(const int32_t width,
+                                        const float min_edge_weight = 1.0f);
+
+// Tracks groups of same colored vertices of a graph with union-find.
+//
+// Colors may only change from white to red or blue, which is how stones are
+// placed in hex. Then two vertices have a same colored path between them if
+// and only if they are in the same group, so a win check is two Find() calls
+// instead of a shortest path search. The adjacency is shared between copies,
+// so copying only duplicates colors and union-find state.
+class CColorConnectivity {
+   private:
+    shared_ptr<const CGraphCSR> adjacency;
+    vector<EVertextColor> colors;
+    CUnionFind groups;
+
+    void JoinColoredVertices(void);
+
+   public:
+    CColorConnectivity() {}
+
+    // takes the topology and the current colors of the graph
+    CColorConnectivity(const CGraph& g);
+
+    // takes a packed hex position, vertices follow the hex layout above
+    CColorConnectivity(const CBitBoard& position);
+
+    // copies colors and groups of another instance, cheaper than assignment
+    // when both already share the same adjacency
+    void Restore(const CColorConnectivity& snapshot) {
+        if (adjacency != snapshot.adjacency) {
+            adjacency = snapshot.adjacency;
+        }
+        colors = snapshot.colors;
+        groups = snapshot.groups;
+    }
+
+    EVertextColor Color(const TVertexID id) const { return colors[id]; }
+
+    // colors a white vertex and joins it to its same colored neighbours,
+    // returns true if any groups were joined
+    bool SetColor(const TVertexID id, const EVertextColor c) {
+        const uint32_t end = adjacency->End(id);
+        bool joined = false;
+
+        colors[id] = c;
+        for (uint32_t i = adjacency->Begin(id); i != end; i++) {
+            const TVertexID n = adjacency->Neighbour(i);
+            if (colors[n] == c) {
+                joined |= groups.Union(id, n);
+            }
+        }
+
+        return (joined);
+    }
+
+    // true if there is a path of one color between the vertices
+    bool Connected(const TVertexID x, const TVertexID y) {
+        return ((colors[x] == colors[y]) && groups.Connected(x, y));
+    }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>  // for platform independent types
+using namespace std;
+using namespace chrono;
+
+// Wall clock budget of a search, optionally cut short by an external cancel
+// flag.
+//
+// Expired() reads the clock, so searches call it once per batch of playouts
+// rather than once per playout, which keeps the overhead far below one
+// percent. Once expired it stays expired, and all threads see that through
+// one relaxed atomic load.
+class CSearchDeadline {
+   private:
+    steady_clock::time_point start_time;
+    steady_clock::time_point end_time;
+    bool unlimited;
+    const atomic<bool>* cancel;
+    mutable atomic<bool> expired;
+
+   public:
+    // never expires, unless cancelled
+    CSearchDeadline(const atomic<bool>* cancel_flag = nullptr)
+        : start_time(steady_clock::now()),
+          end_time(start_time),
+          unlimited(true),
+          cancel(cancel_flag),
+          expired(false) {}
+
+    CSearchDeadline(const milliseconds budget,
+                    const atomic<bool>* cancel_flag = nullptr)
+        : start_time(steady_clock::now()),
+          end_time(start_time + budget),
+          unlimited(false),
+          cancel(cancel_flag),
+          expired(false) {}
+
+    CSearchDeadline(const steady_clock::time_point end,
+                    const atomic<bool>* cancel_flag = nullptr)
+        : start_time(steady_clock::now()),
+          end_time(end),
+          unlimited(false),
+          cancel(cancel_flag),
+          expired(false) {}
+
+    // the part of this deadline which ends at fraction (0..1) of the budget
+    CSearchDeadline Part(const double fraction) const {
+        return (CSearchDeadline(
+            start_time + duration_cast<steady_clock::duration>(
+                             (end_time - start_time) * fraction),
+            cancel));
+    }
+
+    // the part of the time left now which ends at fraction (0..1) of it, for
+    // searches which start after others have used some of the budget
+    CSearchDeadline Remaining(const double fraction = 1.0) const {
+        if (unlimited) {
+            return (CSearchDeadline(cancel));
+        }
+
+        const steady_clock::time_point now = steady_clock::now();
+        return (CSearchDeadline(
+            now + duration_cast<steady_clock::duration>(
+                      (max(end_time, now) - now) * fraction),
+            cancel));
+    }
+
+    bool Unlimited(void) const { return unlimited; }
+    steady_clock::time_point StartTime(void) const { return start_time; }
+    steady_clock::time_point EndTime(void) const { return end_time; }
+
+    bool Cancelled(void) const {
+        return ((cancel != nullptr) && cancel->load(memory_order_relaxed));
+    }
+
+    bool Expired(void) const {
+        if (expired.load(memory_order_relaxed)) {
+            return (true);
+        }
+
+        if (Cancelled() || (!unlimited && (steady_clock::now() >= end_time))) {
+            expired.store(true, memory_order_relaxed);
+            return (true);
+        }
+
+        return (false);
+    }
+};
+
+#endif
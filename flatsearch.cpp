@@ -0,0 +1,321 @@
+#include "flatsearch.h"
+
+#include <algorithm>
+
+#include "inferior.h"
+
+// smallest batch worth a task of its own
+static const int32_t MIN_BATCH_SIZE = 250;
+
+// playouts per batch of the round robin search, long enough to make the clock
+// check negligible and short enough to stop within a fraction of a
+// millisecond
+static const int32_t ROUND_ROBIN_BATCH_SIZE = 64;
+
+// playouts a candidate gets at least per successive halving round, fewer give
+// too noisy rates to drop anyone
+static const int32_t MIN_ROUND_PLAYOUTS = 32;
+
+// One statistics entry per empty cell, and the indices of the cells to
+// evaluate (see SelectCandidateMoves()). Cells which are no candidates keep
+// no playouts, callers skip such entries.
+static void PrepareCandidates(const CBitBoard& position,
+                              const TVectorIDList& empty_cells,
+                              const bool prune, TCandidateStatistics& result,
+                              TVectorIDList& candidates) {
+    result.clear();
+    for (const TVertexID id : empty_cells) {
+        result.push_back(CCandidateStatistics(id));
+    }
+
+    SelectCandidateMoves(position, empty_cells, prune, candidates);
+}
+
+// playouts of the candidates so far
+static int64_t CandidatePlayouts(const TVectorIDList& candidates,
+                                 const TCandidateStatistics& result) {
+    int64_t playouts = 0;
+    for (const int32_t c : candidates) {
+        playouts += result[c].playouts;
+    }
+
+    return (playouts);
+}
+
+CFlatMonteCarlo::CFlatMonteCarlo(CThreadPool& thread_pool)
+    : pool(thread_pool),
+      worker_playouts(thread_pool.NumberOfThreads()),
+      worker_boards(thread_pool.NumberOfThreads()),
+      worker_statistics(thread_pool.NumberOfThreads()),
+      prune_inferior(false),
+      amaf(false),
+      worker_amaf(thread_pool.NumberOfThreads()) {}
+
+void CFlatMonteCarlo::SetPlayoutMode(const EPlayoutMode m) {
+    for (CPlayout& p : worker_playouts) {
+        p.SetMode(m);
+    }
+}
+
+void CFlatMonteCarlo::SetInferiorPruning(const bool on) {
+    prune_inferior = on;
+    for (CPlayout& p : worker_playouts) {
+        p.SetFillCaptured(on);
+    }
+}
+
+void CFlatMonteCarlo::ResetAmaf(const CBitBoard& position) {
+    if (amaf) {
+        for (CAmafStatistics& a : worker_amaf) {
+            a.Reset(position.Width() * position.Width());
+        }
+    }
+}
+
+void CFlatMonteCarlo::MergeAmaf(TCandidateStatistics& result) {
+    if (amaf) {
+        for (const CAmafStatistics& a : worker_amaf) {
+            for (size_t i = 0; i < result.size(); i++) {
+                result[i].amaf_playouts += a.playouts[result[i].vertex];
+                result[i].amaf_wins += a.wins[result[i].vertex];
+            }
+        }
+    }
+}
+
+void CFlatMonteCarlo::SetPlayoutTiming(const bool on) {
+    for (CPlayout& p : worker_playouts) {
+        p.SetTiming(on);
+    }
+}
+
+CPlayoutCounters CFlatMonteCarlo::PlayoutCounters() const {
+    CPlayoutCounters result;
+
+    for (const CPlayout& p : worker_playouts) {
+        result += p.Counters();
+    }
+
+    return (result);
+}
+
+void CFlatMonteCarlo::ResetPlayoutCounters() {
+    for (CPlayout& p : worker_playouts) {
+        p.ResetCounters();
+    }
+}
+
+void CFlatMonteCarlo::RunBatches(const CBitBoard& position,
+                                 const TVectorIDList& empty_cells,
+                                 const TVectorIDList& candidates,
+                                 const EVertextColor mover,
+                                 const int32_t sim_count, seed_seq& seed,
+                                 const CSearchDeadline& deadline,
+                                 TCandidateStatistics& result) {
+    const int32_t candidate_count = static_cast<int32_t>(candidates.size());
+    uint32_t batch_seed_base;
+    seed.generate(&batch_seed_base, &batch_seed_base + 1);
+
+    // split candidates into batches until there are enough tasks to keep
+    // every worker busy, late in the game there are only a few candidates
+    int32_t batches = 1;
+    while ((candidate_count * batches <
+            4 * static_cast<int32_t>(pool.NumberOfThreads())) &&
+           (sim_count / (batches * 2) >= MIN_BATCH_SIZE)) {
+        batches *= 2;
+    }
+
+    // each worker plays on its own copy of the position
+    for (CBitBoard& board : worker_boards) {
+        board = position;
+    }
+
+    batch_wins.assign(candidate_count * batches, 0);
+    batch_playouts.assign(candidate_count * batches, 0);
+    ResetAmaf(position);
+
+    pool.Run(candidate_count * batches,
+             [&](const uint32_t worker, const uint32_t task) {
+                 if (deadline.Expired()) {
+                     return;
+                 }
+
+                 const int32_t candidate_inx = candidates[task / batches];
+                 const int32_t batch = task % batches;
+                 const int32_t batch_sims =
+                     sim_count / batches +
+                     (batch < sim_count % batches ? 1 : 0);
+
+                 seed_seq batch_seed{batch_seed_base, task};
+                 TRandomEngine random_engine(batch_seed);
+
+                 batch_wins[task] = worker_playouts[worker].Run(
+                     worker_boards[worker], empty_cells, candidate_inx, mover,
+                     batch_sims, random_engine,
+                     amaf ? &worker_amaf[worker] : nullptr);
+                 batch_playouts[task] = batch_sims;
+             });
+
+    // merge the batches
+    for (int32_t i = 0; i < candidate_count; i++) {
+        CCandidateStatistics& cs = result[candidates[i]];
+
+        for (int32_t b = 0; b < batches; b++) {
+            cs.wins += batch_wins[i * batches + b];
+            cs.playouts += batch_playouts[i * batches + b];
+        }
+    }
+
+    MergeAmaf(result);
+}
+
+void CFlatMonteCarlo::RunUntil(const CBitBoard& position,
+                               const TVectorIDList& empty_cells,
+                               const TVectorIDList& candidates,
+                               const EVertextColor mover, seed_seq& seed,
+                               const CSearchDeadline& deadline,
+                               TCandidateStatistics& result) {
+    const uint32_t candidate_count = static_cast<uint32_t>(candidates.size());
+    atomic<uint32_t> next_batch(0);
+    uint32_t batch_seed_base;
+    seed.generate(&batch_seed_base, &batch_seed_base + 1);
+
+    if (candidate_count == 0) {
+        return;
+    }
+
+    for (uint32_t w = 0; w < pool.NumberOfThreads(); w++) {
+        worker_boards[w] = position;
+        worker_statistics[w].assign(candidate_count, CCandidateStatistics());
+    }
+    ResetAmaf(position);
+
+    // one task per worker, each one keeps taking the next batch
+    pool.Run(pool.NumberOfThreads(), [&](const uint32_t worker,
+                                         const uint32_t) {
+        while (!deadline.Expired()) {
+            const uint32_t batch = next_batch++;
+            const uint32_t c = batch % candidate_count;
+
+            seed_seq batch_seed{batch_seed_base, batch};
+            TRandomEngine random_engine(batch_seed);
+
+            CCandidateStatistics& cs = worker_statistics[worker][c];
+            cs.wins += worker_playouts[worker].Run(
+                worker_boards[worker], empty_cells, candidates[c], mover,
+                ROUND_ROBIN_BATCH_SIZE, random_engine,
+                amaf ? &worker_amaf[worker] : nullptr);
+            cs.playouts += ROUND_ROBIN_BATCH_SIZE;
+        }
+    });
+
+    for (uint32_t w = 0; w < pool.NumberOfThreads(); w++) {
+        for (uint32_t c = 0; c < candidate_count; c++) {
+            result[candidates[c]].wins += worker_statistics[w][c].wins;
+            result[candidates[c]].playouts += worker_statistics[w][c].playouts;
+        }
+    }
+
+    MergeAmaf(result);
+}
+
+void CFlatMonteCarlo::Evaluate(const CBitBoard& position,
+                               const TVectorIDList& empty_cells,
+                               const EVertextColor mover,
+                               const int32_t sim_count, const uint32_t seed,
+                               TCandidateStatistics& result,
+                               const CSearchDeadline& deadline) {
+    TVectorIDList candidates;
+    seed_seq search_seed{seed};
+
+    PrepareCandidates(position, empty_cells, prune_inferior, result,
+                      candidates);
+
+    RunBatches(position, empty_cells, candidates, mover, sim_count,
+               search_seed, deadline, result);
+}
+
+void CFlatMonteCarlo::EvaluateUntil(const CBitBoard& position,
+                                    const TVectorIDList& empty_cells,
+                                    const EVertextColor mover,
+                                    const CSearchDeadline& deadline,
+                                    const uint32_t seed,
+                                    TCandidateStatistics& result) {
+    TVectorIDList candidates;
+    seed_seq search_seed{seed};
+
+    PrepareCandidates(position, empty_cells, prune_inferior, result,
+                      candidates);
+
+    RunUntil(position, empty_cells, candidates, mover, search_seed, deadline,
+             result);
+}
+
+// Successive halving: the budget is split evenly over log2(n) rounds. Each
+// round shares its part evenly among the remaining candidates, then the
+// better half of them goes on to the next round.
+void CFlatMonteCarlo::SuccessiveHalving(const CBitBoard& position,
+                                        const TVectorIDList& empty_cells,
+                                        const EVertextColor mover,
+                                        const int64_t playout_budget,
+                                        const uint32_t seed,
+                                        TCandidateStatistics& result,
+                                        const CSearchDeadline& deadline) {
+    TVectorIDList candidates;
+
+    PrepareCandidates(position, empty_cells, prune_inferior, result,
+                      candidates);
+
+    int32_t rounds = 1;
+    while ((1 << rounds) < static_cast<int32_t>(candidates.size())) {
+        rounds++;
+    }
+
+    for (int32_t round = 0; candidates.size() > 1; round++) {
+        seed_seq round_seed{seed, static_cast<uint32_t>(round)};
+        const int64_t playouts_before = CandidatePlayouts(candidates, result);
+
+        if (deadline.Unlimited()) {
+            int32_t sim_count = static_cast<int32_t>(
+                playout_budget /
+                (static_cast<int64_t>(rounds) * candidates.size()));
+
+            RunBatches(position, empty_cells, candidates, mover,
+                       max(sim_count, MIN_ROUND_PLAYOUTS), round_seed,
+                       deadline, result);
+        } else {
+            // the time left is shared evenly by the remaining rounds, it is
+            // measured from now as others may have used the budget before
+            CSearchDeadline round_deadline =
+                deadline.Remaining(1.0 / max(rounds - round, 1));
+
+            RunUntil(position, empty_cells, candidates, mover, round_seed,
+                     round_deadline, result);
+        }
+
+        if (deadline.Cancelled()) {
+            break;
+        }
+
+        // a round without playouts tells nothing about the candidates
+        if (CandidatePlayouts(candidates, result) == playouts_before) {
+            if (deadline.Expired()) {
+                break;
+            }
+            continue;
+        }
+
+        // keep the better half, ties are broken by cell id so that the
+        // result does not depend on the order of the empty cell list
+        sort(candidates.begin(), candidates.end(),
+             [&](const int32_t x, const int32_t y) {
+                 const CCandidateStatistics& cx = result[x];
+                 const CCandidateStatistics& cy = result[y];
+
+                 return ((cx.Value() > cy.Value()) ||
+                         ((cx.Value() == cy.Value()) &&
+                          (cx.vertex < cy.vertex)));
+             });
+        candidates.resize((candidates.size() + 1) / 2);
+    }
+}
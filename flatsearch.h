@@ -0,0 +1,149 @@
+#ifndef FLATSEARCH_H
+#define FLATSEARCH_H
+
+#include <cmath>
+#include <cstdint>  // for platform independent types
+#include <vector>
+using namespace std;
+
+#include "bitboard.h"
+#include "deadline.h"
+#include "playout.h"
+#include "threadpool.h"
+
+// playout results of one candidate move
+class CCandidateStatistics {
+   public:
+    TVertexID vertex;
+    int32_t playouts;
+    int32_t wins;
+
+    // all moves as first results, from the playouts of every candidate
+    int32_t amaf_playouts;
+    int32_t amaf_wins;
+
+    CCandidateStatistics(const TVertexID v = -1)
+        : vertex(v), playouts(0), wins(0), amaf_playouts(0), amaf_wins(0) {}
+
+    // own playouts at which the AMAF rate and the own rate weigh the same
+    static const int32_t AmafEquivalence = 1000;
+
+    float Rate(void) const {
+        return (playouts > 0 ? static_cast<float>(wins) / playouts : 0.0f);
+    }
+
+    // rate the moves are chosen by. the AMAF rate is known early but biased,
+    // so its weight sqrt(k / (3 n + k)) fades out with the own playouts n
+    float Value(void) const {
+        if (amaf_playouts == 0) {
+            return (Rate());
+        }
+
+        const float beta =
+            sqrt(static_cast<float>(AmafEquivalence) /
+                 (3.0f * playouts + AmafEquivalence));
+        return ((1.0f - beta) * Rate() +
+                beta * static_cast<float>(amaf_wins) / amaf_playouts);
+    }
+};
+
+typedef vector<CCandidateStatistics> TCandidateStatistics;
+
+// Flat Monte Carlo evaluation of all empty cells of a position, run on a
+// thread pool.
+//
+// Playouts of a candidate are split into batches which are the tasks of the
+// pool. Each batch seeds its own random engine from the search seed and the
+// batch index, so the result does not depend on which worker picked up which
+// batch. Searches with a deadline instead hand out batches round robin over
+// the candidates until time is up, and check the clock once per batch.
+//
+// If the position equals its 180 degree rotation, only one cell of each
+// rotated pair is evaluated. The statistics of the other one stay empty,
+// apart from AMAF results. The same goes for dead and captured cells when
+// inferior cells are pruned.
+class CFlatMonteCarlo {
+   private:
+    CThreadPool& pool;
+
+    // per worker scratch data
+    vector<CPlayout> worker_playouts;
+    vector<CBitBoard> worker_boards;
+
+    // wins and playouts of each batch, merged after the pool is done
+    vector<int32_t> batch_wins;
+    vector<int32_t> batch_playouts;
+
+    // per worker results of the round robin search
+    vector<TCandidateStatistics> worker_statistics;
+
+    // dead and captured cells are no candidates, and the playouts fill the
+    // captured cells (see inferior.h)
+    bool prune_inferior;
+
+    // per worker AMAF results, only gathered if amaf is set
+    bool amaf;
+    vector<CAmafStatistics> worker_amaf;
+
+    // clears the AMAF results of the workers before a run, and adds them to
+    // result after it
+    void ResetAmaf(const CBitBoard& position);
+    void MergeAmaf(TCandidateStatistics& result);
+
+    // adds sim_count playouts of each empty_cells[candidates[i]] to result,
+    // batches which start after the deadline are skipped
+    void RunBatches(const CBitBoard& position,
+                    const TVectorIDList& empty_cells,
+                    const TVectorIDList& candidates, const EVertextColor mover,
+                    const int32_t sim_count, seed_seq& seed,
+                    const CSearchDeadline& deadline,
+                    TCandidateStatistics& result);
+
+    // adds batches of the candidates round robin to result until deadline
+    void RunUntil(const CBitBoard& position, const TVectorIDList& empty_cells,
+                  const TVectorIDList& candidates, const EVertextColor mover,
+                  seed_seq& seed, const CSearchDeadline& deadline,
+                  TCandidateStatistics& result);
+
+   public:
+    CFlatMonteCarlo(CThreadPool& thread_pool);
+
+    void SetPlayoutMode(const EPlayoutMode m);
+    void SetPlayoutTiming(const bool on);
+
+    // gathers all moves as first statistics too, results are then to be
+    // compared by CCandidateStatistics::Value()
+    void SetAmaf(const bool on) { amaf = on; }
+
+    void SetInferiorPruning(const bool on);
+
+    // sum of the playout counters of all workers
+    CPlayoutCounters PlayoutCounters(void) const;
+    void ResetPlayoutCounters(void);
+
+    // evaluates each of empty_cells for mover with sim_count playouts
+    void Evaluate(const CBitBoard& position, const TVectorIDList& empty_cells,
+                  const EVertextColor mover, const int32_t sim_count,
+                  const uint32_t seed, TCandidateStatistics& result,
+                  const CSearchDeadline& deadline = CSearchDeadline());
+
+    // anytime version, evaluates all empty_cells evenly until the deadline
+    void EvaluateUntil(const CBitBoard& position,
+                       const TVectorIDList& empty_cells,
+                       const EVertextColor mover,
+                       const CSearchDeadline& deadline, const uint32_t seed,
+                       TCandidateStatistics& result);
+
+    // shares playout_budget among empty_cells, dropping the worse half of
+    // the candidates after every round. the candidates with the most
+    // playouts are the ones which survived longest. with a time limited
+    // deadline the rounds share the time instead of the playout budget
+    void SuccessiveHalving(const CBitBoard& position,
+                           const TVectorIDList& empty_cells,
+                           const EVertextColor mover,
+                           const int64_t playout_budget, const uint32_t seed,
+                           TCandidateStatistics& result,
+                           const CSearchDeadline& deadline = CSearchDeadline());
+};
+
+#endif
@@ -1,22 +1,26 @@
 #include "graph.h"
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
-#include <fstream>
 #include <random>
-#include <sstream>
+
+#include "mappedfile.h"
 
 using namespace chrono;
 
 
 void CVertex::AddEdge(const TEdgeID id) { edge_list.insert(id); }
 
+void CVertex::RemoveEdge(const TEdgeID id) { edge_list.erase(id); }
+
 void CVertex::RebuildEdgeList() {
     edge_list.clear();
 
     for (TEdges::const_iterator edge = Owner.EdgeList().cbegin();
          edge != Owner.EdgeList().cend(); edge++) {
-        if ((edge->From().ID() == vertex_id) ||
-            (edge->To().ID() == vertex_id)) {
+        if (!edge->Removed() && ((edge->From().ID() == vertex_id) ||
+                                 (edge->To().ID() == vertex_id))) {
             AddEdge(edge->ID());
         }
     }
@@ -24,6 +28,65 @@ void CVertex::RebuildEdgeList() {
 
 ///////////////////////////////////////////////////////////////////////////
 
+static const char* SkipBlanks(const char* p, const char* last) {
+    while ((p != last) && ((*p == ' ') || (*p == '\t') || (*p == '\r'))) {
+        p++;
+    }
+    return (p);
+}
+
+// reads one number and the blanks in front of it
+template <typename T>
+static bool ParseNumber(const char*& p, const char* last, T& value) {
+    p = SkipBlanks(p, last);
+    from_chars_result r = from_chars(p, last, value);
+    if (r.ec != errc()) {
+        return (false);
+    }
+
+    p = r.ptr;
+    return (true);
+}
+
+bool ParseEdgeList(const char* first, const char* last, uint32_t& vertex_count,
+                   TWeightedEdges& edge_list) {
+    const char* p = first;
+    bool first_line = true;
+
+    vertex_count = 0;
+    while (p != last) {
+        const char* eol = find(p, last, '\n');
+
+        // first line indicates vertex count
+        if (first_line) {
+            first_line = false;
+            if (!ParseNumber(p, eol, vertex_count)) {
+                return (false);
+            }
+        } else {
+            // edge definitions
+            uint32_t from_vertex_index;
+            uint32_t to_vertex_index;
+            float edge_cost;
+
+            if (ParseNumber(p, eol, from_vertex_index) &&
+                ParseNumber(p, eol, to_vertex_index) &&
+                ParseNumber(p, eol, edge_cost) &&
+                (from_vertex_index < vertex_count) &&
+                (to_vertex_index < vertex_count)) {
+                edge_list.push_back(CWeightedEdge(from_vertex_index,
+                                                  to_vertex_index, edge_cost));
+            }
+        }
+
+        p = (eol == last) ? last : eol + 1;
+    }
+
+    return (!first_line);
+}
+
+///////////////////////////////////////////////////////////////////////////
+
 bool CEdge::operator==(const CEdge& x) {
     return ((&x.Owner == &Owner) && (x.From().ID() == from_vertex.ID()) &&
             (x.To().ID() == to_vertex.ID()));
@@ -32,44 +95,127 @@ bool CEdge::operator==(const CEdge& x) {
 ///////////////////////////////////////////////////////////////////////////
 
 void CGraph::AddEdge(CVertex& from, CVertex& to, const float edge_value) {
-    CEdge le(*this, from, to, edges.size(), edge_value);
-    TEdges::iterator it = find(edges.begin(), edges.end(), le);
+    TEdgeIndex::const_iterator it =
+        edge_index.find(EdgeKey(from.ID(), to.ID()));
+    version++;
 
     // if it is not available in graph.edgelist
-    if (it == edges.end()) {
+    if (it == edge_index.end()) {
+        CEdge le(*this, from, to, edges.size(), edge_value);
+
         // add to graph edge list
         edges.push_back(le);
+        edge_index[EdgeKey(from.ID(), to.ID())] = le.ID();
 
         from.AddEdge(le.ID());
         to.AddEdge(le.ID());
     } else {
         // edge already exists, then just update the weight
-        it->SetValue(edge_value);
+        edges[it->second].SetValue(edge_value);
     }
 }
 
+void CGraph::AddEdges(const TWeightedEdges& edge_list) {
+    TWeightedEdges sorted;
+
+    // put the smaller id first so that both directions meet in the sort
+    sorted.reserve(edge_list.size());
+    for (const CWeightedEdge& e : edge_list) {
+        sorted.push_back(CWeightedEdge(min(e.from, e.to), max(e.from, e.to),
+                                       e.value));
+    }
+
+    // stable, so duplicates stay in the order they were given
+    stable_sort(sorted.begin(), sorted.end(),
+                [](const CWeightedEdge& x, const CWeightedEdge& y) {
+                    return ((x.from < y.from) ||
+                            ((x.from == y.from) && (x.to < y.to)));
+                });
+
+    edges.reserve(edges.size() + sorted.size());
+    edge_index.reserve(edges.size() + sorted.size());
+
+    for (size_t i = 0; i < sorted.size(); i++) {
+        // only the last one of the duplicates counts
+        if ((i + 1 < sorted.size()) && (sorted[i].from == sorted[i + 1].from) &&
+            (sorted[i].to == sorted[i + 1].to)) {
+            continue;
+        }
+
+        AddEdge(GetVertex(sorted[i].from), GetVertex(sorted[i].to),
+                sorted[i].value);
+    }
+}
+
+TEdgeID CGraph::FindEdge(const TVertexID x, const TVertexID y) const {
+    TEdgeIndex::const_iterator it = edge_index.find(EdgeKey(x, y));
+    return (it == edge_index.end() ? -1 : it->second);
+}
+
 void CGraph::RemoveEdge(CVertex& from, CVertex& to) {
-    CEdge le(*this, from, to);
-    TEdges::iterator it = find(edges.begin(), edges.end(), le);
+    TEdgeIndex::const_iterator it =
+        edge_index.find(EdgeKey(from.ID(), to.ID()));
 
-    if (it != edges.end()) {
-        edges.erase(it);
+    if (it != edge_index.end()) {
+        const TEdgeID id = it->second;
 
-        from.RebuildEdgeList();
-        to.RebuildEdgeList();
+        edges[id].removed = true;
+        removed_edge_count++;
+        edge_index.erase(it);
+        version++;
+
+        from.RemoveEdge(id);
+        to.RemoveEdge(id);
     }
 }
 
+void CGraph::Compact() {
+    if (removed_edge_count == 0) {
+        return;
+    }
+
+    TEdges live_edges;
+    live_edges.reserve(edges.size() - removed_edge_count);
+    edge_index.clear();
+
+    for (const CEdge& e : edges) {
+        if (!e.Removed()) {
+            CEdge le(*this, e.From(), e.To(), live_edges.size(), e.Value());
+            edge_index[EdgeKey(le.From().ID(), le.To().ID())] = le.ID();
+            live_edges.push_back(le);
+        }
+    }
+
+    edges.swap(live_edges);
+    removed_edge_count = 0;
+    version++;
+
+    // one pass over the edges instead of RebuildEdgeList() for each vertex
+    for (CVertex& v : vertices) {
+        v.ClearEdgeList();
+    }
+    for (const CEdge& e : edges) {
+        GetVertex(e.From().ID()).AddEdge(e.ID());
+        GetVertex(e.To().ID()).AddEdge(e.ID());
+    }
+}
+
+// take seed from system timer in order to generate random numbers
 CGraph::CGraph(const uint32_t vertex_count,
-               const float pertange_of_edge_density) {
-    // take seed from system timer in order to generate random numbers
-    default_random_engine generator(
-        static_cast<uint32_t>(system_clock::now().time_since_epoch().count()));
+               const float pertange_of_edge_density)
+    : CGraph(vertex_count, pertange_of_edge_density,
+             static_cast<uint32_t>(
+                 system_clock::now().time_since_epoch().count())) {}
+
+CGraph::CGraph(const uint32_t vertex_count,
+               const float pertange_of_edge_density, const uint32_t seed)
+    : removed_edge_count(0), version(0) {
+    default_random_engine generator(seed);
 
     uniform_real_distribution<float> weight_distribution(1.0f, 10.0f);
-    uniform_real_distribution<float> density_distribution(0.0f, 1.0f);
 
     // create vertices first at required amount
+    vertices.reserve(vertex_count);
     for (uint32_t vertex_index = 0; vertex_index < vertex_count;
          vertex_index++) {
         (void)AddVertex();
@@ -77,18 +223,32 @@ CGraph::CGraph(const uint32_t vertex_count,
 
     // create edge connectivity between vertices at desired density
     // and each edge weight should be between 1.0 and 10.0
-    // ok, lets do..
     //
-    // from all possible source vertices
-    for (uint32_t source = 0; source < vertex_count - 1; source++) {
-        // to all possible destination vertices
-        for (uint32_t dest = source + 1; dest < vertex_count; dest++) {
-            // if random value in specified range
-            if (density_distribution(generator) <= pertange_of_edge_density) {
-                // then add edge between two vertices
-                AddEdge(GetVertex(source), GetVertex(dest),
-                        weight_distribution(generator));
-            }
+    // instead of a coin flip for every pair of vertices, jump straight to
+    // the next pair that gets an edge. the gaps between edges are
+    // geometrically distributed, so the work is linear in the edge count
+    if (pertange_of_edge_density <= 0.0f) {
+        return;
+    }
+
+    geometric_distribution<uint64_t> gap_distribution(
+        min(pertange_of_edge_density, 1.0f));
+
+    // pairs are walked in the order source < dest, row by row
+    uint32_t source = 0;
+    uint64_t dest = 1 + gap_distribution(generator);
+
+    while (source + 1 < vertex_count) {
+        if (dest < vertex_count) {
+            // then add edge between two vertices
+            AddEdge(GetVertex(source), GetVertex(dest),
+                    weight_distribution(generator));
+            dest += 1 + gap_distribution(generator);
+        } else {
+            // carry the overshoot into the next row, which starts at
+            // source + 2
+            dest = dest - vertex_count + source + 2;
+            source++;
         }
     }
 }
@@ -101,44 +261,23 @@ CGraph::CGraph(const uint32_t vertex_count,
 // 0 4 24            - from_vertex  to_vertex  distance
 // ..
 // ..
-CGraph::CGraph(const string filename) {
-    ifstream txt_stream_file(filename);
-    string line = "";
-    bool first_line = true;
+CGraph::CGraph(const string filename) : removed_edge_count(0), version(0) {
+    CMappedFile file(filename);
     uint32_t vertex_count = 0;
+    TWeightedEdges edge_list;
 
     // if file is there and successfully opened
-    if (txt_stream_file.is_open()) {
-        // read text file line by line
-        while (getline(txt_stream_file, line)) {
-            istringstream string_stream(line);
-
-            // first line indicates vertex count
-            if (first_line) {
-                first_line = false;
-
-                string_stream >> vertex_count;
-
-                for (uint32_t i = 0; i < vertex_count; i++) {
-                    (void)AddVertex();
-                }
-            } else {
-                // edge definitions
-                uint32_t from_vertex_index;
-                uint32_t to_vertex_index;
-                float edge_cost;
-                string_stream >> from_vertex_index >> to_vertex_index >>
-                    edge_cost;
-
-                AddEdge(GetVertex(from_vertex_index),
-                        GetVertex(to_vertex_index), edge_cost);
-            }
+    if (file.IsOpen()) {
+        (void)ParseEdgeList(file.Data(), file.Data() + file.Size(),
+                            vertex_count, edge_list);
+
+        vertices.reserve(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++) {
+            (void)AddVertex();
         }
 
-        // close the file
-        txt_stream_file.close();
-    } else {
-        perror("\nFile Error ");
+        // all edges at once, duplicates are sorted out instead of searched
+        AddEdges(edge_list);
     }
 }
 
@@ -147,5 +286,6 @@ TVertexID CGraph::AddVertex(const EVertextColor c) {
     lv.Color = c;
 
     vertices.push_back(lv);
+    version++;
     return (lv.ID());
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <cstdint>  // for platform independent types
 #include <iostream>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 using namespace std;
@@ -31,6 +32,8 @@ class CVertex {
     const TVertexEdgeList& EdgeList() const { return (edge_list); }
 
     void AddEdge(const TEdgeID edge_id);
+    void RemoveEdge(const TEdgeID edge_id);
+    void ClearEdgeList() { edge_list.clear(); }
     void RebuildEdgeList();
 
     // constructor
@@ -60,12 +63,18 @@ class CEdge {
     const CVertex& to_vertex;
     float value_of_edge;
 
+    // removed edges stay in place so that the other ids do not move, see
+    // CGraph::RemoveEdge()
+    bool removed;
+    friend class CGraph;
+
    public:
     const TEdgeID ID(void) const { return (edge_id); }
     const CVertex& From(void) const { return from_vertex; }
     const CVertex& To(void) const { return to_vertex; }
     const float Value(void) const { return value_of_edge; }
     void SetValue(const float val) { value_of_edge = val; }
+    bool Removed(void) const { return removed; }
 
     // constructor
     CEdge(const CGraph& g, const CVertex& source, const CVertex& dest,
@@ -74,7 +83,8 @@ class CEdge {
           from_vertex(source.ID() < dest.ID() ? source : dest),
           to_vertex(source.ID() < dest.ID() ? dest : source),
           edge_id(id),
-          value_of_edge(val) {}
+          value_of_edge(val),
+          removed(false) {}
 
     // copier constructor
     CEdge(const CEdge& se)
@@ -82,34 +92,77 @@ class CEdge {
           from_vertex(se.from_vertex),
           to_vertex(se.to_vertex),
           edge_id(se.edge_id),
-          value_of_edge(se.value_of_edge) {}
-
-    // required for vector<CEdge>.erase()
-    CEdge& operator=(CEdge&& x) { return x; }
+          value_of_edge(se.value_of_edge),
+          removed(se.removed) {}
 
     bool operator==(const CEdge& x);
 };
 
 typedef vector<CEdge> TEdges;
 
+// one undirected edge of an edge list
+class CWeightedEdge {
+   public:
+    TVertexID from;
+    TVertexID to;
+    float value;
+
+    CWeightedEdge(const TVertexID f = 0, const TVertexID t = 0,
+                  const float v = 0.0f)
+        : from(f), to(t), value(v) {}
+};
+
+typedef vector<CWeightedEdge> TWeightedEdges;
+
+// parses the text format of CGraph(const string filename) held in
+// [first, last). numbers are read with from_chars, so there is no stream
+// and no copy per line. lines that are not three numbers, or that name a
+// vertex out of range, are skipped. returns false if there is no vertex count
+bool ParseEdgeList(const char* first, const char* last, uint32_t& vertex_count,
+                   TWeightedEdges& edge_list);
+
+// edge ids by their ends, see CGraph::EdgeKey()
+typedef unordered_map<uint64_t, TEdgeID> TEdgeIndex;
+
 class CGraph {
    private:
     TVertices vertices;
     TEdges edges;
+    TEdgeIndex edge_index;
+    uint32_t removed_edge_count;
+
+    // changes whenever vertices or edges are added or removed, or AddEdge()
+    // updates a weight. vertex colors do not count
+    uint64_t version;
+
+    // smaller vertex id in the upper half, same as CEdge orders its ends
+    static uint64_t EdgeKey(const TVertexID x, const TVertexID y) {
+        return (x < y ? (uint64_t(uint32_t(x)) << 32) | uint32_t(y)
+                      : (uint64_t(uint32_t(y)) << 32) | uint32_t(x));
+    }
 
    public:
-    CGraph() {}
+    CGraph() : removed_edge_count(0), version(0) {}
 
     // this constructor creates graph randomly
     CGraph(const uint32_t vertex_count, const float pertange_of_edge_density);
 
+    // same, but repeatable
+    CGraph(const uint32_t vertex_count, const float pertange_of_edge_density,
+           const uint32_t seed);
+
     // creates graph from a file
     CGraph(const string filename);
 
     uint32_t NumberOfVertices(void) const { return vertices.size(); }
-    uint32_t NumberOfEdges(void) const { return edges.size(); }
+    uint32_t NumberOfEdges(void) const {
+        return (edges.size() - removed_edge_count);
+    }
+    uint32_t NumberOfRemovedEdges(void) const { return removed_edge_count; }
+    uint64_t Version(void) const { return version; }
 
     const TVertices& VerticesList(void) const { return vertices; }
+    // removed edges are still listed, skip them by CEdge::Removed()
     const TEdges& EdgeList(void) const { return edges; }
 
     CVertex& GetVertex(const TVertexID id) { return (vertices[id]); }
@@ -120,8 +173,21 @@ class CGraph {
     // adds new edge if edge is not there, otherwise just updates weight
     void AddEdge(CVertex& x, CVertex& y, const float edge_value);
 
-    // removes the edge from x to y, if it is there.
+    // adds a whole edge list at once. duplicates are dropped by sorting, the
+    // last one of them keeps its weight just like repeated AddEdge() calls
+    void AddEdges(const TWeightedEdges& edge_list);
+
+    // id of the edge between x and y, -1 if there is none
+    TEdgeID FindEdge(const TVertexID x, const TVertexID y) const;
+
+    // removes the edge from x to y, if it is there. the edge is only marked
+    // as removed, so it takes constant time and the ids of the other edges
+    // stay valid. adding the edge again gives it a new id
     void RemoveEdge(CVertex& from, CVertex& to);
+
+    // drops the removed edges for good and renumbers the rest in their
+    // order, which invalidates the edge ids held outside of the graph
+    void Compact(void);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "graphcsr.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+CGraphCSR::CGraphCSR(const CGraph& g) {
+    TWeightedEdges edges;
+
+    edges.reserve(g.NumberOfEdges());
+    for (const CEdge& e : g.EdgeList()) {
+        if (e.Removed()) {
+            continue;
+        }
+        edges.push_back(CWeightedEdge(e.From().ID(), e.To().ID(), e.Value()));
+    }
+
+    Build(g.NumberOfVertices(), edges);
+}
+
+// binary file layout, all in the byte order of the writer:
+//   header
+//   offsets     (vertex_count + 1) x uint32_t
+//   neighbours  arc_count x int32_t
+//   weights     arc_count x float
+// the header keeps the arrays 4 byte aligned within the mapped pages
+class CGraphCSRFileHeader {
+   public:
+    char magic[8];
+    uint32_t vertex_count;
+    uint32_t arc_count;
+};
+
+static const char csr_file_magic[8] = {'H', 'E', 'X', 'C', 'S', 'R', '0', '1'};
+
+static bool IsBinaryGraph(const CMappedFile& file) {
+    return ((file.Size() >= sizeof(csr_file_magic)) &&
+            equal(csr_file_magic, csr_file_magic + sizeof(csr_file_magic),
+                  file.Data()));
+}
+
+// example text file
+// 20                - vertex count
+// 0 1 17            - from_vertex  to_vertex  distance
+// 0 2 2             - from_vertex  to_vertex  distance
+// ..
+CGraphCSR::CGraphCSR(const string filename) {
+    shared_ptr<const CMappedFile> file = make_shared<const CMappedFile>(filename);
+    TWeightedEdges edges;
+    uint32_t vertex_count = 0;
+
+    if (file->IsOpen()) {
+        // a broken binary file is no text file either, it stays empty
+        if (IsBinaryGraph(*file)) {
+            if (!MapBinary(file)) {
+                cerr << "\nFile Error : corrupt binary graph " << filename
+                     << endl;
+            }
+        } else {
+            (void)ParseEdgeList(file->Data(), file->Data() + file->Size(),
+                                vertex_count, edges);
+        }
+    }
+
+    if (!mapping) {
+        Build(vertex_count, edges);
+    }
+}
+
+CGraphCSR& CGraphCSR::operator=(const CGraphCSR& x) {
+    if (this != &x) {
+        offsets = x.offsets;
+        neighbours = x.neighbours;
+        weights = x.weights;
+        mapping = x.mapping;
+        vertex_count = x.vertex_count;
+        arc_count = x.arc_count;
+
+        if (mapping) {
+            offset_data = x.offset_data;
+            neighbour_data = x.neighbour_data;
+            weight_data = x.weight_data;
+        } else {
+            PointToVectors();
+        }
+    }
+    return (*this);
+}
+
+CGraphCSR& CGraphCSR::operator=(CGraphCSR&& x) {
+    if (this != &x) {
+        offsets = move(x.offsets);
+        neighbours = move(x.neighbours);
+        weights = move(x.weights);
+        mapping = move(x.mapping);
+        vertex_count = x.vertex_count;
+        arc_count = x.arc_count;
+
+        if (mapping) {
+            offset_data = x.offset_data;
+            neighbour_data = x.neighbour_data;
+            weight_data = x.weight_data;
+        } else {
+            PointToVectors();
+        }
+
+        // leave x empty, but usable
+        x.offsets.assign(1, 0);
+        x.PointToVectors();
+    }
+    return (*this);
+}
+
+void CGraphCSR::PointToVectors() {
+    offset_data = offsets.data();
+    neighbour_data = neighbours.data();
+    weight_data = weights.data();
+    vertex_count = offsets.size() - 1;
+    arc_count = neighbours.size();
+}
+
+// uses the arrays right inside a file with the binary magic, false if the
+// header does not fit the size of the file or the arrays are corrupt
+bool CGraphCSR::MapBinary(const shared_ptr<const CMappedFile>& file) {
+    CGraphCSRFileHeader header;
+
+    if (file->Size() < sizeof(header)) {
+        return (false);
+    }
+
+    memcpy(&header, file->Data(), sizeof(header));
+
+    const size_t expected_size =
+        sizeof(header) + (header.vertex_count + 1ull) * sizeof(uint32_t) +
+        header.arc_count * (sizeof(TVertexID) + sizeof(float));
+    if (file->Size() != expected_size) {
+        return (false);
+    }
+
+    const char* p = file->Data() + sizeof(header);
+    offset_data = reinterpret_cast<const uint32_t*>(p);
+    p += (header.vertex_count + 1ull) * sizeof(uint32_t);
+    neighbour_data = reinterpret_cast<const TVertexID*>(p);
+    p += header.arc_count * sizeof(TVertexID);
+    weight_data = reinterpret_cast<const float*>(p);
+
+    // every search trusts the arrays, so a corrupt file must not get through
+    if ((offset_data[0] != 0) ||
+        (offset_data[header.vertex_count] != header.arc_count)) {
+        return (false);
+    }
+    for (uint32_t v = 0; v < header.vertex_count; v++) {
+        if (offset_data[v + 1] < offset_data[v]) {
+            return (false);
+        }
+    }
+    for (uint32_t a = 0; a < header.arc_count; a++) {
+        if ((neighbour_data[a] < 0) ||
+            (static_cast<uint32_t>(neighbour_data[a]) >= header.vertex_count)) {
+            return (false);
+        }
+    }
+
+    offsets.clear();
+    neighbours.clear();
+    weights.clear();
+    vertex_count = header.vertex_count;
+    arc_count = header.arc_count;
+    mapping = file;
+    return (true);
+}
+
+bool CGraphCSR::Save(const string filename) const {
+    ofstream bin_stream_file(filename, ios::binary | ios::trunc);
+
+    if (!bin_stream_file.is_open()) {
+        perror("\nFile Error ");
+        return (false);
+    }
+
+    CGraphCSRFileHeader header;
+    memcpy(header.magic, csr_file_magic, sizeof(header.magic));
+    header.vertex_count = vertex_count;
+    header.arc_count = arc_count;
+
+    bin_stream_file.write(reinterpret_cast<const char*>(&header),
+                          sizeof(header));
+    bin_stream_file.write(reinterpret_cast<const char*>(offset_data),
+                          (vertex_count + 1ull) * sizeof(uint32_t));
+    bin_stream_file.write(reinterpret_cast<const char*>(neighbour_data),
+                          arc_count * sizeof(TVertexID));
+    bin_stream_file.write(reinterpret_cast<const char*>(weight_data),
+                          arc_count * sizeof(float));
+
+    return (bin_stream_file.good());
+}
+
+// counting sort of the edge ends by vertex, two passes over the edges
+void CGraphCSR::Build(const uint32_t vertex_count,
+                      const TWeightedEdges& edges) {
+    offsets.assign(vertex_count + 1, 0);
+    for (const CWeightedEdge& e : edges) {
+        offsets[e.from + 1]++;
+        offsets[e.to + 1]++;
+    }
+
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    neighbours.resize(offsets[vertex_count]);
+    weights.resize(offsets[vertex_count]);
+
+    vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (const CWeightedEdge& e : edges) {
+        neighbours[next[e.from]] = e.to;
+        weights[next[e.from]++] = e.value;
+
+        neighbours[next[e.to]] = e.from;
+        weights[next[e.to]++] = e.value;
+    }
+
+    mapping.reset();
+    PointToVectors();
+}
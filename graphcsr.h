@@ -0,0 +1,81 @@
+#ifndef GRAPHCSR_H
+#define GRAPHCSR_H
+
+#include <cstdint>  // for platform independent types
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "graph.h"
+#include "mappedfile.h"
+
+// Compressed sparse row adjacency of an undirected graph.
+//
+// Neighbours of vertex v are Neighbour(i) for i in [Begin(v), End(v)), and
+// Weight(i) is the value of the edge to that neighbour. Every edge shows up in
+// the lists of both of its ends. The arrays are contiguous, so walking the
+// neighbours of a vertex is a linear scan instead of a hash set walk followed
+// by edge and vertex lookups.
+//
+// The arrays either live in the object or in a memory mapped binary file
+// written by Save(), which is used as it is without any parsing. Copies of a
+// mapped adjacency share the mapping.
+class CGraphCSR {
+   private:
+    vector<uint32_t> offsets;
+    vector<TVertexID> neighbours;
+    vector<float> weights;
+    shared_ptr<const CMappedFile> mapping;
+
+    // point either to the vectors or into the mapping
+    const uint32_t* offset_data;
+    const TVertexID* neighbour_data;
+    const float* weight_data;
+    uint32_t vertex_count;
+    uint32_t arc_count;
+
+    void Build(const uint32_t vertex_count, const TWeightedEdges& edges);
+    void PointToVectors(void);
+    bool MapBinary(const shared_ptr<const CMappedFile>& file);
+
+   public:
+    CGraphCSR() : offsets(1, 0) { PointToVectors(); }
+
+    // takes the edges of the graph, vertex colors are not part of it
+    CGraphCSR(const CGraph& g);
+
+    CGraphCSR(const uint32_t vertex_count, const TWeightedEdges& edges) {
+        Build(vertex_count, edges);
+    }
+
+    // maps a binary file written by Save(), or reads the text format of
+    // CGraph(const string filename). converting a text file to binary is
+    // CGraphCSR(text_file).Save(binary_file). a corrupt binary file is
+    // reported and leaves the graph empty
+    CGraphCSR(const string filename);
+
+    CGraphCSR(const CGraphCSR& x) { *this = x; }
+    CGraphCSR(CGraphCSR&& x) { *this = move(x); }
+    CGraphCSR& operator=(const CGraphCSR& x);
+    CGraphCSR& operator=(CGraphCSR&& x);
+
+    // writes the binary format, in the byte order of this machine
+    bool Save(const string filename) const;
+
+    uint32_t NumberOfVertices(void) const { return (vertex_count); }
+
+    // each edge is counted once per end
+    uint32_t NumberOfArcs(void) const { return (arc_count); }
+
+    uint32_t Begin(const TVertexID v) const { return (offset_data[v]); }
+    uint32_t End(const TVertexID v) const { return (offset_data[v + 1]); }
+    uint32_t Degree(const TVertexID v) const {
+        return (offset_data[v + 1] - offset_data[v]);
+    }
+
+    TVertexID Neighbour(const uint32_t i) const { return (neighbour_data[i]); }
+    float Weight(const uint32_t i) const { return (weight_data[i]); }
+};
+
+#endif
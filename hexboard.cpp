@@ -1,11 +1,21 @@
 #include "hexboard.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
 
+#include "inferior.h"
+
+// entries of the solver and transposition tables per board cell, so that
+// every board of a self-play match does not hold tables for 11x11. an 11x11
+// board gets 1 << 19 entries in each
+static const uint64_t TABLE_ENTRIES_PER_CELL = 1 << 13;
+
 // convert vertex color to string
 static char VertexColorToStr(const EVertextColor c) {
     char result = ' ';
@@ -48,7 +58,9 @@ static ostream& operator<<(ostream& stream, const EVertextColor c) {
 }
 
 // destructor
-CHexBoard::~CHexBoard() { cout << "\nBYE !.. \n"; }
+CHexBoard::~CHexBoard() {
+    StopPondering();
+}
 
 void CHexBoard::CreateHexBoardVertices() {
     for (int32_t i = 0; i < board_width_height * board_width_height; i++) {
@@ -58,18 +70,23 @@ void CHexBoard::CreateHexBoardVertices() {
 }
 
 void CHexBoard::CreateEdgesBetweenVertices() {
-    for (uint32_t from = 0; from < graph.NumberOfVertices() - 1; from++) {
-        for (uint32_t to = from + 1; to < graph.NumberOfVertices(); to++) {
-            uint32_t fromX = from % board_width_height;
-            uint32_t fromY = from / board_width_height;
-
-            uint32_t toX = to % board_width_height;
-            uint32_t toY = to / board_width_height;
-
-            if (((fromX == toX) && (toY == fromY + 1)) ||
-                ((fromY == toY) && (toX == fromX + 1)) ||
-                ((toX == fromX - 1) && (toY == fromY + 1))) {
-                graph.AddEdge(graph.GetVertex(from), graph.GetVertex(to), 1.0f);
+    const int32_t w = board_width_height;
+
+    // every cell links forward to its right, lower left and lower
+    // neighbours, the other three link back to it from their side
+    for (int32_t y = 0; y < w; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            CVertex& from = graph.GetVertex(y * w + x);
+
+            if (x + 1 < w) {
+                graph.AddEdge(from, graph.GetVertex(y * w + x + 1), 1.0f);
+            }
+            if ((y + 1 < w) && (x > 0)) {
+                graph.AddEdge(from, graph.GetVertex((y + 1) * w + x - 1),
+                              1.0f);
+            }
+            if (y + 1 < w) {
+                graph.AddEdge(from, graph.GetVertex((y + 1) * w + x), 1.0f);
             }
         }
     }
@@ -104,6 +121,9 @@ void CHexBoard::CreateWinnerVerticesAndEdges() {
 
 void CHexBoard::OccupyVertex(const TVertexID v_id, const EVertextColor c) {
     graph.GetVertex(v_id).Color = c;
+    board_bits.Set(v_id, c);
+    connectivity.SetColor(v_id, c);
+    tree_search.Advance(v_id);
 
     // remove the occupied vertex from the list in order to
     // accomplish faster AI calculations
@@ -115,6 +135,16 @@ void CHexBoard::OccupyVertex(const TVertexID v_id, const EVertextColor c) {
 void CHexBoard::PrintBoard() {
     string row_spacer = " ";
 
+    // the winning path is only needed for drawing, so search for it here
+    shortest_path.ShortestPath.clear();
+    if (CheckForWinner()) {
+        TVertexID source_vertex;
+        TVertexID target_vertex;
+
+        WinnerVertices(active_player, source_vertex, target_vertex);
+        shortest_path.DijkstraShortestPath(source_vertex, target_vertex);
+    }
+
     cout << "\n\n";
 
     // draw top y-coordinates
@@ -158,7 +188,7 @@ void CHexBoard::PrintBoard() {
             // if there is a winner then draw path as capital
             if (find(shortest_path.ShortestPath.cbegin(),
                      shortest_path.ShortestPath.cend(),
-                     &v) == shortest_path.ShortestPath.cend()) {
+                     v.ID()) == shortest_path.ShortestPath.cend()) {
                 cout << v.Color;
             } else {
                 cout << static_cast<char>(toupper(VertexColorToStr(v.Color)));
@@ -275,54 +305,104 @@ string CHexBoard::VertextIDToCoordStr(const TVertexID id) {
 
 // active player must be AI
 float CHexBoard::DoMonteCarlo(int32_t id_inx, int32_t sim_count) {
-    int32_t winner_count_active_player = 0;
-    float result_rate = static_cast<float>(sim_count);
-    EVertextColor tmp_active_player = active_player;
+    // playouts run on the packed copy of the board, graph stays untouched
+    int32_t winner_count_active_player = playout.Run(
+        board_bits, unoccupied_vertices, id_inx, active_player, sim_count,
+        random_engine, search_settings.amaf ? &amaf_statistics : nullptr);
 
-    TVectorIDList uovl;
-    uovl.reserve(unoccupied_vertices.size() - 1);  // speed up
+    // bigger values are better
+    return (static_cast<float>(winner_count_active_player) /
+            static_cast<float>(sim_count));
+}
 
-    do {
-        // unoccupied vertices list
-        for (int32_t i = 0; i != unoccupied_vertices.size(); i++) {
-            if (i != id_inx) {
-                uovl.push_back(unoccupied_vertices[i]);
-            }
-        }
+// thread pool and search objects follow the thread count of the settings
+void CHexBoard::PrepareThreadPool() {
+    uint32_t threads = search_settings.threads;
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
 
-        // vertex under test
-        graph.GetVertex(unoccupied_vertices[id_inx]).Color = active_player;
+    if (!thread_pool || (thread_pool->NumberOfThreads() != threads)) {
+        flat_search.reset();
+        thread_pool.reset(new CThreadPool(threads));
+        flat_search.reset(new CFlatMonteCarlo(*thread_pool));
+    }
 
-        // shuffle unoccupied vertices
-        shuffle(uovl.begin(), uovl.end(), random_engine);
+    flat_search->SetPlayoutMode(search_settings.playout_mode);
+    flat_search->SetPlayoutTiming(search_settings.stats);
+    flat_search->SetAmaf(search_settings.amaf);
+    flat_search->SetInferiorPruning(search_settings.prune_inferior);
+}
 
-        // fill all rest empty places randomly
-        while (!uovl.empty()) {
-            NextPlayer();
+// stone counters of all playout engines, reset after reading
+CPlayoutCounters CHexBoard::PlayoutCounters() {
+    CPlayoutCounters result = playout.Counters();
+    result += tree_search.Playout().Counters();
 
-            // removing the end is faster and still random because of shuffle
-            // above
-            graph.GetVertex(uovl.back()).Color = active_player;
-            uovl.pop_back();
-        }
+    playout.ResetCounters();
+    tree_search.Playout().ResetCounters();
 
-        // check for winner
-        // checking after filling the board totally is ok too.
-        // because there is no drawn in this game
-        active_player = tmp_active_player;
-        if (CheckForWinner()) {
-            ++winner_count_active_player;
-        }
+    if (flat_search) {
+        result += flat_search->PlayoutCounters();
+        flat_search->ResetPlayoutCounters();
+    }
+
+    return (result);
+}
 
-        // pop back to the initial state
-        for (TVertexID id : unoccupied_vertices) {
-            graph.GetVertex(id).Color = EVertextColor::vtWHITE;
+// prints what the search did for the AI move, counters are read before
+// PlayoutCounters() resets them
+void CHexBoard::ReportSearch(const TVertexID move, const double seconds) {
+    static const char* engine_names[] = {"flat", "mcts", "halving"};
+    CSearchReport report;
+
+    report.move_number =
+        board_width_height * board_width_height - unoccupied_vertices.size() + 1;
+    report.engine = engine_names[static_cast<int>(search_settings.engine)];
+    report.move = VertextIDToCoordStr(move);
+    report.seconds = seconds;
+    report.playouts = playout.Counters();
+    report.playouts += tree_search.Playout().Counters();
+    if (flat_search) {
+        report.playouts += flat_search->PlayoutCounters();
+    }
+    report.shortest_paths = shortest_path.Counters();
+    if (solver && (solver->Counters().solves > 0)) {
+        static const char* result_names[] = {"win", "loss", "unknown"};
+        report.solver = solver->Counters();
+        report.solver_result = result_names[static_cast<int>(solver_result)];
+    }
+
+    if (search_settings.engine == ESearchEngine::seMCTS) {
+        vector<CMCTSNode> children;
+        tree_search.RootChildren(children);
+        for (const CMCTSNode& child : children) {
+            report.candidates.emplace_back(VertextIDToCoordStr(child.move),
+                                           child.visits, child.wins);
+        }
+    } else {
+        for (const CCandidateStatistics& cs : candidate_statistics) {
+            report.candidates.emplace_back(VertextIDToCoordStr(cs.vertex),
+                                           cs.playouts, cs.wins);
         }
-    } while (--sim_count > 0);
+    }
 
-    // bigger values are better
-    result_rate = static_cast<float>(winner_count_active_player) / result_rate;
-    return (result_rate);
+    stable_sort(report.candidates.begin(), report.candidates.end(),
+                [](const CCandidateReport& x, const CCandidateReport& y) {
+                    return (x.playouts > y.playouts);
+                });
+
+    cout << report.Text();
+
+    if (!search_settings.stats_log.empty()) {
+        ofstream log_file(search_settings.stats_log, ios::app);
+
+        if (!log_file.is_open()) {
+            perror("\nFile Error ");
+        } else {
+            log_file << report.Json() << "\n";
+        }
+    }
 }
 
 // The program takes turns.It inputs the human(or machine opponent if playing
@@ -332,22 +412,210 @@ float CHexBoard::DoMonteCarlo(int32_t id_inx, int32_t sim_count) {
 // forward by randomly selecting successive moves until there is a winner.The
 // trial is counted as a win or loss.The ratio : wins / trials are the AIs
 // metric for picking which next move to make.
-TVertexID CHexBoard::AI_MOVE(int32_t level) {
+TVertexID CHexBoard::AI_MOVE(int32_t level, const CSearchDeadline& deadline) {
     float best_rate = -1.0;
     TVertexID best_move_id = unoccupied_vertices[0];
 
-    for (int32_t id_inx = 0; id_inx != unoccupied_vertices.size(); id_inx++) {
-        float rate = DoMonteCarlo(id_inx, level);
+    playout.SetMode(search_settings.playout_mode);
+    tree_search.Playout().SetMode(search_settings.playout_mode);
+    playout.SetTiming(search_settings.stats);
+    tree_search.Playout().SetTiming(search_settings.stats);
+    playout.SetFillCaptured(search_settings.prune_inferior);
+    tree_search.SetInferiorPruning(search_settings.prune_inferior);
+
+    // few empty cells left, try to solve the position exactly first. a
+    // proven win is played without playouts, a loss or an unfinished solve
+    // leaves the choice to the search
+    if (unoccupied_vertices.size() <= search_settings.solver_threshold) {
+        if (!solver) {
+            solver.reset(new CProofNumberSolver(
+                TABLE_ENTRIES_PER_CELL * board_width_height *
+                board_width_height));
+        }
+
+        // half of the time left, the search needs the rest
+        TVertexID move;
+        solver_result = solver->Solve(board_bits, active_player,
+                                      search_settings.solver_nodes,
+                                      deadline.Remaining(0.5), move);
+
+        if (solver_result == ESolverResult::srWIN) {
+            candidate_statistics.clear();
+            return (move);
+        }
+    }
+
+    // the search gets what the solver left of the time
+    const CSearchDeadline search_deadline = deadline.Remaining();
+
+    if (search_settings.engine == ESearchEngine::seMCTS) {
+        if (!transpositions && (search_settings.transposition_entries > 0)) {
+            transpositions.reset(new CTranspositionTable(min<uint64_t>(
+                search_settings.transposition_entries,
+                TABLE_ENTRIES_PER_CELL * board_width_height *
+                    board_width_height)));
+        }
+        tree_search.SetTranspositionTable(transpositions.get());
+
+        // same number of playouts as the flat search would spend, or as many
+        // as fit into the time
+        int64_t iterations =
+            search_deadline.Unlimited()
+                ? static_cast<int64_t>(level) * unoccupied_vertices.size()
+                : numeric_limits<int64_t>::max();
+
+        return (tree_search.Search(board_bits, unoccupied_vertices,
+                                   active_player, iterations, random_engine,
+                                   search_deadline));
+    }
 
-        if (rate > best_rate) {
-            best_rate = rate;
-            best_move_id = unoccupied_vertices[id_inx];
+    if (search_settings.engine == ESearchEngine::seSUCCESSIVE_HALVING) {
+        int64_t budget = search_settings.playout_budget;
+        if (budget <= 0) {
+            // a quarter of what the uniform search spends
+            budget =
+                static_cast<int64_t>(level) * unoccupied_vertices.size() / 4;
+        }
+
+        PrepareThreadPool();
+        flat_search->SuccessiveHalving(board_bits, unoccupied_vertices,
+                                       active_player, budget, random_engine(),
+                                       candidate_statistics, search_deadline);
+
+        // the last round finalists have the most playouts, best of them wins
+        int32_t most_playouts = 0;
+        for (const CCandidateStatistics& cs : candidate_statistics) {
+            if ((cs.playouts > most_playouts) ||
+                ((cs.playouts == most_playouts) && (cs.Value() > best_rate))) {
+                most_playouts = cs.playouts;
+                best_rate = cs.Value();
+                best_move_id = cs.vertex;
+            }
+        }
+
+        return (best_move_id);
+    }
+
+    if ((search_settings.threads == 1) && search_deadline.Unlimited()) {
+        TVectorIDList candidates;
+        SelectCandidateMoves(board_bits, unoccupied_vertices,
+                             search_settings.prune_inferior, candidates);
+
+        vector<bool> is_candidate(unoccupied_vertices.size(), false);
+        for (const TVertexID id_inx : candidates) {
+            is_candidate[id_inx] = true;
+        }
+
+        amaf_statistics.Reset(board_width_height * board_width_height);
+        candidate_statistics.clear();
+        for (int32_t id_inx = 0; id_inx != unoccupied_vertices.size();
+             id_inx++) {
+            const TVertexID id = unoccupied_vertices[id_inx];
+            candidate_statistics.emplace_back(id);
+
+            if (search_deadline.Expired()) {
+                continue;  // cancelled
+            }
+            if (!is_candidate[id_inx]) {
+                continue;
+            }
+
+            float rate = DoMonteCarlo(id_inx, level);
+
+            candidate_statistics.back().playouts = level;
+            candidate_statistics.back().wins =
+                static_cast<int32_t>(rate * level + 0.5f);
+        }
+
+        // AMAF results are complete only after the last candidate
+        if (search_settings.amaf) {
+            for (CCandidateStatistics& cs : candidate_statistics) {
+                cs.amaf_playouts = amaf_statistics.playouts[cs.vertex];
+                cs.amaf_wins = amaf_statistics.wins[cs.vertex];
+            }
+        }
+    } else {
+        // root parallel, candidates are shared out to all threads
+        PrepareThreadPool();
+        if (search_deadline.Unlimited()) {
+            flat_search->Evaluate(board_bits, unoccupied_vertices,
+                                  active_player, level, random_engine(),
+                                  candidate_statistics, search_deadline);
+        } else {
+            flat_search->EvaluateUntil(board_bits, unoccupied_vertices,
+                                       active_player, search_deadline,
+                                       random_engine(), candidate_statistics);
+        }
+    }
+
+    for (const CCandidateStatistics& cs : candidate_statistics) {
+        if ((cs.playouts > 0) && (cs.Value() > best_rate)) {
+            best_rate = cs.Value();
+            best_move_id = cs.vertex;
         }
     }
 
     return (best_move_id);
 }
 
+void CHexBoard::SetSearchSettings(const CSearchSettings& settings) {
+    search_settings = settings;
+}
+
+TVertexID CHexBoard::SearchMove(const milliseconds think_time,
+                                const atomic<bool>* cancel) {
+    if (think_time.count() > 0) {
+        return (AI_MOVE(search_settings.level,
+                        CSearchDeadline(think_time, cancel)));
+    }
+
+    return (AI_MOVE(search_settings.level, CSearchDeadline(cancel)));
+}
+
+void CHexBoard::StartPondering(const EVertextColor to_move) {
+    if (!search_settings.ponder ||
+        (search_settings.engine != ESearchEngine::seMCTS)) {
+        return;
+    }
+
+    StopPondering();
+    ponder_stop = false;
+    ponder_engine.seed(random_engine());
+
+    // no more than the AI would spend on its own move, the thread works on
+    // copies so the board can be printed and read meanwhile
+    int64_t iterations =
+        static_cast<int64_t>(search_settings.level) * unoccupied_vertices.size();
+
+    ponder_thread = thread([this, iterations](CBitBoard position,
+                                              TVectorIDList empty,
+                                              EVertextColor to_move) {
+        (void)tree_search.Search(position, empty, to_move, iterations,
+                                 ponder_engine, CSearchDeadline(&ponder_stop));
+    }, board_bits, unoccupied_vertices, to_move);
+}
+
+void CHexBoard::StopPondering() {
+    if (ponder_thread.joinable()) {
+        ponder_stop = true;
+        ponder_thread.join();
+    }
+}
+
+const TCandidateStatistics& CHexBoard::LastCandidateStatistics() const {
+    return (candidate_statistics);
+}
+
+bool CHexBoard::Play(const TVertexID id) {
+    StopPondering();
+    OccupyVertex(id, active_player);
+
+    bool won = CheckForWinner();
+    NextPlayer();
+
+    return (won);
+}
+
 // switch to the next player
 void CHexBoard::NextPlayer() {
     if (active_player == EVertextColor::vtRED) {
@@ -381,30 +649,93 @@ void CHexBoard::DoMove() {
                 cout << "Invalid input!\n";
             }
         } while (!valid_input);
+
+        // the tree keeps what was pondered below the human's move
+        StopPondering();
     } else {
         cout << "\nThinking..." << endl;
 
-        id = AI_MOVE(5000);
+        // pondered playouts are not part of this move's report
+        if (search_settings.stats) {
+            (void)PlayoutCounters();
+            shortest_path.ResetCounters();
+            if (solver) {
+                solver->ResetCounters();
+            }
+        }
+
+        steady_clock::time_point search_start = steady_clock::now();
+        id = SearchMove(milliseconds(search_settings.think_time));
+        double seconds =
+            duration<double>(steady_clock::now() - search_start).count();
+
         cout << "AI Player "
              << static_cast<char>(toupper(VertexColorToStr(active_player)))
              << " move: " << VertextIDToCoordStr(id) << endl;
+
+        if (search_settings.ponder &&
+            (search_settings.engine == ESearchEngine::seMCTS)) {
+            cout << "Pondering kept " << tree_search.ReusedVisits()
+                 << " playouts" << endl;
+        }
+
+        if (search_settings.engine == ESearchEngine::seSUCCESSIVE_HALVING) {
+            int64_t total = 0;
+            int32_t chosen = 0;
+            for (const CCandidateStatistics& cs : candidate_statistics) {
+                total += cs.playouts;
+                if (cs.vertex == id) chosen = cs.playouts;
+            }
+
+            cout << "Successive halving: " << total << " playouts over "
+                 << candidate_statistics.size() << " candidates, " << chosen
+                 << " on " << VertextIDToCoordStr(id) << endl;
+        }
+
+        if (search_settings.stats) {
+            ReportSearch(id, seconds);
+        }
+
+        CPlayoutCounters counters = PlayoutCounters();
+        if (search_settings.playout_mode == EPlayoutMode::pmEARLY_STOP) {
+            cout << "Early stop skipped " << counters.skipped_stones
+                 << " of "
+                 << counters.placed_stones + counters.skipped_stones
+                 << " stone placements" << endl;
+        }
     }
 
     OccupyVertex(id, active_player);
+
+    // use the human's time for the replies to the AI's move. the human
+    // moves next, active_player changes only after this move
+    if ((active_player == ai_player) && !CheckForWinner()) {
+        StartPondering(human_player);
+    }
 }
 
-// any winner?
-bool CHexBoard::CheckForWinner() {
+// virtual vertices which have to be connected for the color to win
+void CHexBoard::WinnerVertices(const EVertextColor c, TVertexID& source,
+                               TVertexID& target) {
     // red player source and target vertices
-    TVertexID source_vertex = left_vertex;
-    TVertexID target_vertex = right_vertex;
+    source = left_vertex;
+    target = right_vertex;
 
-    if (active_player == EVertextColor::vtBLUE) {
-        source_vertex = top_vertex;
-        target_vertex = bottom_vertex;
+    if (c == EVertextColor::vtBLUE) {
+        source = top_vertex;
+        target = bottom_vertex;
     }
+}
+
+// any winner?
+bool CHexBoard::CheckForWinner() {
+    TVertexID source_vertex;
+    TVertexID target_vertex;
+
+    WinnerVertices(active_player, source_vertex, target_vertex);
 
-    return (shortest_path.DijkstraShortestPath(source_vertex, target_vertex));
+    // groups are kept up to date in OccupyVertex, no path search needed
+    return (connectivity.Connected(source_vertex, target_vertex));
 }
 
 // starts the game
@@ -431,4 +762,5 @@ void CHexBoard::Start() {
     cout << "Player "
          << static_cast<char>(toupper(VertexColorToStr(active_player)))
          << " won the game!" << endl;
+    cout << "\nBYE !.. \n";
 }
\ No newline at end of file
@@ -1,17 +1,100 @@
 #ifndef HEXBOARD_H
 #define HEXBOARD_H
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>  // for platform independent types
+#include <memory>
 #include <random>
+#include <string>
+#include <thread>
 #include <unordered_set>
 using namespace std;
 using namespace chrono;
 
+#include "bitboard.h"
+#include "connectivity.h"
+#include "deadline.h"
+#include "flatsearch.h"
 #include "graph.h"  // our graph class
+#include "mcts.h"
+#include "playout.h"
 #include "shortestpath.h"
+#include "solver.h"
+#include "threadpool.h"
+
+// search algorithm of the AI
+enum class ESearchEngine : uint8_t {
+    seFLAT_MONTE_CARLO,
+    seMCTS,
+    seSUCCESSIVE_HALVING
+};
 
-typedef vector<TVertexID> TVectorIDList;
+// tells how the AI searches for its moves
+class CSearchSettings {
+   public:
+    ESearchEngine engine;
+
+    // number of search threads, 0 means one thread per core and 1 keeps
+    // the single threaded search
+    uint32_t threads;
+
+    EPlayoutMode playout_mode;
+
+    // dead and captured cells are no candidates, and flat search playouts
+    // start with the captured cells filled
+    bool prune_inferior;
+
+    // flat searches credit every playout to all cells of the mover too
+    // (all moves as first) and blend that into the move choice
+    bool amaf;
+
+    // playouts per candidate move
+    int32_t level;
+
+    // total playouts of the successive halving search, 0 means a quarter of
+    // what the uniform search spends on the same position
+    int64_t playout_budget;
+
+    // wall clock time per AI move in milliseconds, 0 searches by level
+    int32_t think_time;
+
+    // keep searching the tree while the human thinks, only the tree search
+    // can carry the work over to its next move
+    bool ponder;
+
+    // most entries of the tree search's transposition table, smaller boards
+    // get fewer. 0 searches without
+    int64_t transposition_entries;
+
+    // the AI solves positions with at most this many empty cells exactly
+    // before it searches, and plays a proven win at once. 0 never solves
+    uint32_t solver_threshold;
+
+    // positions one solve may search, a harder position is left to the
+    // search
+    int64_t solver_nodes;
+
+    // prints a report of every AI move, and appends it as one JSON line to
+    // stats_log if that is set
+    bool stats;
+    string stats_log;
+
+    CSearchSettings()
+        : engine(ESearchEngine::seFLAT_MONTE_CARLO),
+          threads(0),
+          playout_mode(EPlayoutMode::pmFULL_FILL),
+          prune_inferior(true),
+          amaf(false),
+          level(5000),
+          playout_budget(0),
+          think_time(0),
+          ponder(false),
+          transposition_entries(1 << 20),
+          solver_threshold(24),
+          solver_nodes(100000),
+          stats(false) {}
+};
 
 class CHexBoard {
    private:
@@ -19,7 +102,7 @@ class CHexBoard {
     int32_t board_width_height;
 
     // random engine
-    default_random_engine random_engine;
+    TRandomEngine random_engine;
 
     // left-right and top-bottom vertices are used to find winner
     TVertexID left_vertex;
@@ -41,6 +124,37 @@ class CHexBoard {
     // if there is a winner, contains the path
     CShortestPath shortest_path;
 
+    // same colored groups, tells the winner without a path search
+    CColorConnectivity connectivity;
+
+    // packed copy of the board colors, used by the playouts
+    CBitBoard board_bits;
+    CPlayout playout;
+    CAmafStatistics amaf_statistics;
+
+    // parallel search, created on first use
+    CSearchSettings search_settings;
+    unique_ptr<CThreadPool> thread_pool;
+    unique_ptr<CFlatMonteCarlo> flat_search;
+    TCandidateStatistics candidate_statistics;
+
+    // tree search, follows every move played so that it can reuse the tree
+    CMCTSearch tree_search;
+
+    // statistics of the positions the tree search has seen in this game,
+    // created on first use
+    unique_ptr<CTranspositionTable> transpositions;
+
+    // exact endgame search, created on first use. its table keeps the
+    // proofs of this game
+    unique_ptr<CProofNumberSolver> solver;
+    ESolverResult solver_result;
+
+    // background search on the tree during the human's turn
+    thread ponder_thread;
+    atomic<bool> ponder_stop;
+    TRandomEngine ponder_engine;
+
     void CreateHexBoardVertices(void);
     void CreateEdgesBetweenVertices(void);
     void CreateWinnerVerticesAndEdges(void);
@@ -49,14 +163,25 @@ class CHexBoard {
     void ChoosePlayer(void);
 
     bool UserInputToVertextID(const string& in_str, TVertexID& id);
-    string VertextIDToCoordStr(const TVertexID id);
 
     void NextPlayer(void);
+    void WinnerVertices(const EVertextColor c, TVertexID& source,
+                        TVertexID& target);
     bool CheckForWinner(void);
     void DoMove(void);
 
     float DoMonteCarlo(int32_t id_inx, int32_t sim_count);
-    TVertexID AI_MOVE(int32_t level = 1000);
+    void PrepareThreadPool(void);
+    CPlayoutCounters PlayoutCounters(void);
+    void ReportSearch(const TVertexID move, const double seconds);
+    TVertexID AI_MOVE(int32_t level = 1000,
+                      const CSearchDeadline& deadline = CSearchDeadline());
+
+    // pondering runs on its own thread and owns tree_search until it is
+    // stopped, so every other use of the tree has to stop it first. to_move
+    // is the player who moves next, the one whose reply is searched
+    void StartPondering(const EVertextColor to_move);
+    void StopPondering(void);
 
     void OccupyVertex(const TVertexID v_id, const EVertextColor c);
 
@@ -66,18 +191,56 @@ class CHexBoard {
         : board_width_height(board_width),
           human_player(EVertextColor::vtWHITE),
           ai_player(EVertextColor::vtWHITE),
-          active_player(EVertextColor::vtWHITE),
+          active_player(EVertextColor::vtBLUE),
           shortest_path(graph),
+          board_bits(board_width),
+          tree_search(board_width),
+          solver_result(ESolverResult::srUNKNOWN),
+          ponder_stop(false),
           random_engine(random_device{}()) {
         CreateHexBoardVertices();
         CreateEdgesBetweenVertices();
 
         // create virtual vertices to identify the winner
         CreateWinnerVerticesAndEdges();
+
+        connectivity = CColorConnectivity(graph);
     };
 
     ~CHexBoard(void);
 
+    void SetSearchSettings(const CSearchSettings& settings);
+
+    // searches the best move of the player to move within think_time, or
+    // by level if think_time is zero. returns the best move found until the
+    // time is up or the cancel flag is set
+    TVertexID SearchMove(const milliseconds think_time,
+                         const atomic<bool>* cancel = nullptr);
+
+    // playouts and wins of every candidate of the last flat search
+    const TCandidateStatistics& LastCandidateStatistics(void) const;
+
+    // headless play without Start(), for engine matches. blue moves first,
+    // and SearchMove() searches for the player to move
+    void Seed(const uint32_t seed) { random_engine.seed(seed); }
+    EVertextColor PlayerToMove(void) const { return active_player; }
+    const TVectorIDList& EmptyCells(void) const { return unoccupied_vertices; }
+
+    // places id for the player to move, returns true if the move wins.
+    // stops pondering first
+    bool Play(const TVertexID id);
+
+    // the tree search works on the move of the player to move in the
+    // background until the next Play(), if pondering is set
+    void Ponder(void) { StartPondering(active_player); }
+
+    // playouts of the tree search below the current position, and how many
+    // of them its last search found in the tree already
+    int32_t TreeVisits(void) { return tree_search.RootVisits(); }
+    int32_t ReusedTreeVisits(void) const { return tree_search.ReusedVisits(); }
+
+    string VertextIDToCoordStr(const TVertexID id);
+
     void Start(void);
 };
 
@@ -0,0 +1,192 @@
+#include "inferior.h"
+
+// neighbours of (x, y) in order around the cell, each one touches the next
+static const int32_t NEIGHBOUR_DX[6] = {1, 1, 0, -1, -1, 0};
+static const int32_t NEIGHBOUR_DY[6] = {0, -1, -1, 0, 1, 1};
+
+// Whether a cell is useless for a color, by the 6 bit masks of its own and
+// its opponent's neighbours, bit i is neighbour i. Every two neighbours
+// which are not the opponent's need a way around the cell, one way or the
+// other, over own neighbours only.
+class CUselessTable {
+   public:
+    bool useless[64][64];
+
+    CUselessTable() {
+        for (uint32_t own = 0; own < 64; own++) {
+            for (uint32_t opp = 0; opp < 64; opp++) {
+                useless[own][opp] = ((own & opp) == 0) && Check(own, opp);
+            }
+        }
+    }
+
+    static bool Check(const uint32_t own, const uint32_t opp) {
+        for (int32_t a = 0; a < 6; a++) {
+            if (opp & (1u << a)) continue;
+
+            for (int32_t b = a + 1; b < 6; b++) {
+                if (opp & (1u << b)) continue;
+
+                bool forward = true;
+                for (int32_t i = a + 1; i < b; i++) {
+                    forward = forward && (own & (1u << i));
+                }
+
+                bool backward = true;
+                for (int32_t i = (b + 1) % 6; i != a; i = (i + 1) % 6) {
+                    backward = backward && (own & (1u << i));
+                }
+
+                if (!forward && !backward) {
+                    return (false);
+                }
+            }
+        }
+
+        return (true);
+    }
+};
+
+static const CUselessTable useless_table;
+
+// masks of the red and blue neighbours of the cell. the board edges count
+// as stones of their color, the corners outside both ways belong to neither
+// color so that they never make a cell look useless
+static void NeighbourMasks(const CBitBoard& position, const int32_t x,
+                           const int32_t y, uint32_t& red, uint32_t& blue) {
+    const int32_t width = position.Width();
+    const TBitBoardBits& red_bits = position.Bits(EVertextColor::vtRED);
+    const TBitBoardBits& blue_bits = position.Bits(EVertextColor::vtBLUE);
+
+    red = 0;
+    blue = 0;
+    for (int32_t i = 0; i < 6; i++) {
+        const int32_t nx = x + NEIGHBOUR_DX[i];
+        const int32_t ny = y + NEIGHBOUR_DY[i];
+        const bool off_x = (nx < 0) || (nx >= width);
+        const bool off_y = (ny < 0) || (ny >= width);
+
+        if (off_x && off_y) {
+            continue;
+        }
+        if (off_x) {
+            red |= 1u << i;
+        } else if (off_y) {
+            blue |= 1u << i;
+        } else {
+            red |= ((red_bits[ny] >> nx) & 1u) << i;
+            blue |= ((blue_bits[ny] >> nx) & 1u) << i;
+        }
+    }
+}
+
+static bool IsUseless(const CBitBoard& position, const EVertextColor c,
+                      const int32_t x, const int32_t y) {
+    uint32_t red;
+    uint32_t blue;
+    NeighbourMasks(position, x, y, red, blue);
+
+    return (c == EVertextColor::vtRED ? useless_table.useless[red][blue]
+                                      : useless_table.useless[blue][red]);
+}
+
+void FindUselessCells(const CBitBoard& position, const EVertextColor c,
+                      TBitBoardBits& useless) {
+    const int32_t width = position.Width();
+
+    useless.fill(0);
+    for (int32_t y = 0; y < width; y++) {
+        for (int32_t x = 0; x < width; x++) {
+            if ((position.Get(y * width + x) == EVertextColor::vtWHITE) &&
+                IsUseless(position, c, x, y)) {
+                useless[y] |= 1u << x;
+            }
+        }
+    }
+}
+
+int32_t FillCapturedCells(CBitBoard& position) {
+    const int32_t width = position.Width();
+    int32_t filled = 0;
+    bool changed = true;
+
+    // a filled cell may make its neighbours useless too
+    while (changed) {
+        changed = false;
+
+        for (int32_t y = 0; y < width; y++) {
+            for (int32_t x = 0; x < width; x++) {
+                const TVertexID id = y * width + x;
+                if (position.Get(id) != EVertextColor::vtWHITE) continue;
+
+                uint32_t red;
+                uint32_t blue;
+                NeighbourMasks(position, x, y, red, blue);
+
+                if (useless_table.useless[blue][red]) {
+                    position.Set(id, EVertextColor::vtRED);
+                } else if (useless_table.useless[red][blue]) {
+                    position.Set(id, EVertextColor::vtBLUE);
+                } else {
+                    continue;
+                }
+
+                filled++;
+                changed = true;
+            }
+        }
+    }
+
+    return (filled);
+}
+
+void PruneInferiorCells(const CBitBoard& position,
+                        const TVectorIDList& empty_cells,
+                        TVectorIDList& candidates) {
+    CBitBoard filled = position;
+    (void)FillCapturedCells(filled);
+
+    candidates.clear();
+    for (const TVertexID id : empty_cells) {
+        if (filled.Get(id) == EVertextColor::vtWHITE) {
+            candidates.push_back(id);
+        }
+    }
+
+    if (candidates.empty()) {
+        candidates = empty_cells;
+    }
+}
+
+void SelectCandidateMoves(const CBitBoard& position,
+                          const TVectorIDList& empty_cells, const bool prune,
+                          TVectorIDList& candidates) {
+    const int32_t cell_count = position.Width() * position.Width();
+    vector<bool> relevant(cell_count, !prune);
+
+    if (prune) {
+        TVectorIDList relevant_cells;
+        PruneInferiorCells(position, empty_cells, relevant_cells);
+
+        for (const TVertexID id : relevant_cells) {
+            relevant[id] = true;
+        }
+    }
+
+    for (const bool symmetric : {position.IsSymmetric(), false}) {
+        candidates.clear();
+        for (int32_t i = 0; i < static_cast<int32_t>(empty_cells.size());
+             i++) {
+            const TVertexID id = empty_cells[i];
+
+            if (relevant[id] &&
+                (!symmetric || (id <= position.RotatedCell(id)))) {
+                candidates.push_back(i);
+            }
+        }
+
+        if (!candidates.empty()) {
+            break;
+        }
+    }
+}
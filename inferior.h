@@ -0,0 +1,49 @@
+#ifndef INFERIOR_H
+#define INFERIOR_H
+
+#include <cstdint>  // for platform independent types
+#include <vector>
+using namespace std;
+
+#include "batchplayout.h"  // for TVectorIDList
+#include "bitboard.h"
+
+// Inferior cell analysis of hex positions.
+//
+// An empty cell is useless for a color if every two of its neighbours
+// which are not the opponent's are already joined around the cell by stones
+// or the edge of that color. Then any path of the color through the cell
+// can go around it, and whether the color connects never depends on the
+// cell. The board edges count as stones of their color.
+//
+// A cell useless for one color is captured by the other: giving it to the
+// other color changes the winner of no fill of the board. A cell useless
+// for both is dead. Neither kind is worth a move, the player to move does
+// at least as well with any other move, so both can be dropped from the
+// candidates as long as one candidate is left.
+
+// sets the bit (see CBitBoard::BitIndex) of every empty cell which is
+// useless for color c
+void FindUselessCells(const CBitBoard& position, const EVertextColor c,
+                      TBitBoardBits& useless);
+
+// gives every captured cell to the color which captured it, and dead cells
+// to red, until no more are found. returns the number of cells filled
+int32_t FillCapturedCells(CBitBoard& position);
+
+// the empty_cells which are still empty after FillCapturedCells(), or all of
+// them if none is
+void PruneInferiorCells(const CBitBoard& position,
+                        const TVectorIDList& empty_cells,
+                        TVectorIDList& candidates);
+
+// indices into empty_cells of the moves a search evaluates: no dead and
+// captured cells if prune is set, and in a symmetric position only the cell
+// of each rotated pair with the smaller id, its twin is equally good. the
+// fill order of the captured cells may break the symmetry, then the twins
+// are taken as well. empty only if empty_cells is
+void SelectCandidateMoves(const CBitBoard& position,
+                          const TVectorIDList& empty_cells, const bool prune,
+                          TVectorIDList& candidates);
+
+#endif
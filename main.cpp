@@ -101,7 +101,10 @@
 // Human Player O move:
 // -----------------------------------------------------------------------
 
+#include <sstream>
+
 #include "hexboard.h"
+#include "selfplay.h"
 
 int32_t ChooseBoardDimension() {
     int32_t result = 0;
@@ -142,7 +145,199 @@ int32_t ChooseBoardDimension() {
     return (result);
 }
 
-int main() {
+// one search option of the command line, false if arg is none or its value
+// is out of range
+bool ParseSearchOption(const string& arg, CSearchSettings& settings) {
+    string value = arg.substr(arg.find('=') + 1);
+
+    if (arg == "--engine=flat") {
+        settings.engine = ESearchEngine::seFLAT_MONTE_CARLO;
+    } else if (arg == "--engine=mcts") {
+        settings.engine = ESearchEngine::seMCTS;
+    } else if (arg == "--engine=halving") {
+        settings.engine = ESearchEngine::seSUCCESSIVE_HALVING;
+    } else if (arg.compare(0, 9, "--budget=") == 0) {
+        settings.playout_budget = atoll(value.c_str());
+    } else if (arg == "--no-prune") {
+        settings.prune_inferior = false;
+    } else if (arg == "--amaf") {
+        settings.amaf = true;
+    } else if (arg == "--playout=full") {
+        settings.playout_mode = EPlayoutMode::pmFULL_FILL;
+    } else if (arg == "--playout=early") {
+        settings.playout_mode = EPlayoutMode::pmEARLY_STOP;
+    } else if (arg == "--playout=batch") {
+        settings.playout_mode = EPlayoutMode::pmBATCH;
+    } else if (arg.compare(0, 7, "--time=") == 0) {
+        settings.think_time = atoi(value.c_str());
+    } else if (arg.compare(0, 8, "--level=") == 0) {
+        settings.level = atoi(value.c_str());
+
+        // win rates need at least one playout per candidate
+        return (settings.level > 0);
+    } else if (arg.compare(0, 5, "--tt=") == 0) {
+        settings.transposition_entries = atoll(value.c_str());
+    } else if (arg.compare(0, 8, "--solve=") == 0) {
+        settings.solver_threshold = static_cast<uint32_t>(atoi(value.c_str()));
+    } else if (arg.compare(0, 15, "--solver-nodes=") == 0) {
+        settings.solver_nodes = atoll(value.c_str());
+    } else if (arg == "--ponder") {
+        settings.ponder = true;
+    } else if (arg == "--stats") {
+        settings.stats = true;
+    } else if (arg.compare(0, 12, "--stats-log=") == 0) {
+        settings.stats = true;
+        settings.stats_log = value;
+    } else if (arg.compare(0, 10, "--threads=") == 0) {
+        settings.threads = static_cast<uint32_t>(atoi(value.c_str()));
+    } else {
+        return (false);
+    }
+
+    return (true);
+}
+
+void PrintOptions() {
+    cout << "Options:\n";
+    cout << "   --engine=flat|mcts|halving\n";
+    cout << "                        search algorithm of the AI\n";
+    cout << "   --budget=N           total playouts of halving "
+            "search\n";
+    cout << "   --threads=N          search threads, 0 for all "
+            "cores\n";
+    cout << "   --level=N            playouts per candidate move\n";
+    cout << "   --time=MS            think time per AI move, "
+            "overrides level\n";
+    cout << "   --playout=full|early fill whole board or stop at "
+            "first connection\n";
+    cout << "   --playout=batch      fill 64 boards at once with "
+            "SIMD flood fill\n";
+    cout << "   --tt=N               most transposition table entries "
+            "of mcts, 0 for none\n";
+    cout << "   --no-prune           also search dead and captured "
+            "cells\n";
+    cout << "   --amaf               blend all moves as first results "
+            "into flat searches\n";
+    cout << "   --solve=N            solve positions with N or fewer "
+            "empty cells exactly, 0 never\n";
+    cout << "   --solver-nodes=N     positions one solve may search\n";
+    cout << "   --ponder             search during the human's turn "
+            "(mcts engine)\n";
+    cout << "   --stats              report playouts, timings and "
+            "candidates of every AI move\n";
+    cout << "   --stats-log=FILE     also append the reports as JSON "
+            "lines to FILE\n";
+    cout << "Engine match without human player:\n";
+    cout << "   --selfplay=N         play N games of player A against "
+            "player B\n";
+    cout << "   --boards=7,11,...    board sizes the games cycle "
+            "through\n";
+    cout << "   --opening=N          random moves before the engines "
+            "take over\n";
+    cout << "   --no-swap            A always plays blue, otherwise "
+            "every second game\n";
+    cout << "   --seed=N             seed of the match, games are "
+            "reproducible by level\n";
+    cout << "   --games-threads=N    games played at once, 0 for all "
+            "cores\n";
+    cout << "   --results=FILE       one JSON line per game, default "
+            "selfplay.jsonl\n";
+    cout << "   --a:OPTION --b:OPTION\n";
+    cout << "                        search option of one player, "
+            "e.g. --b:engine=mcts\n";
+}
+
+// reads search options from the command line, e.g.
+//   HexBoard.exe --engine=mcts --threads=4
+bool ParseSearchSettings(int argc, char* argv[], CSearchSettings& settings) {
+    for (int i = 1; i < argc; i++) {
+        if (!ParseSearchOption(argv[i], settings)) {
+            cout << "Invalid option: " << argv[i] << "\n";
+            PrintOptions();
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+// reads an engine match from the command line, e.g.
+//   HexBoard.exe --selfplay=1000 --boards=7,11 --level=500 --b:engine=mcts
+// plain search options are for both players
+bool ParseSelfPlaySettings(int argc, char* argv[],
+                           CSelfPlaySettings& settings) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value = arg.substr(arg.find('=') + 1);
+        bool valid = true;
+
+        if (arg.compare(0, 11, "--selfplay=") == 0) {
+            settings.games = atoi(value.c_str());
+        } else if (arg.compare(0, 9, "--boards=") == 0) {
+            settings.board_sizes.clear();
+            istringstream sizes(value);
+            string size;
+            while (getline(sizes, size, ',')) {
+                int32_t w = atoi(size.c_str());
+                valid = valid && (w > 1) && (w <= HEX_MAX_BOARD_WIDTH);
+                settings.board_sizes.push_back(w);
+            }
+            valid = valid && !settings.board_sizes.empty();
+        } else if (arg.compare(0, 10, "--opening=") == 0) {
+            settings.opening_moves = atoi(value.c_str());
+        } else if (arg == "--no-swap") {
+            settings.swap_sides = false;
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            settings.seed = static_cast<uint32_t>(atoll(value.c_str()));
+        } else if (arg.compare(0, 16, "--games-threads=") == 0) {
+            settings.threads = static_cast<uint32_t>(atoi(value.c_str()));
+        } else if (arg.compare(0, 10, "--results=") == 0) {
+            settings.results_file = value;
+        } else if ((arg.compare(0, 4, "--a:") == 0) ||
+                   (arg.compare(0, 4, "--b:") == 0)) {
+            valid = ParseSearchOption("--" + arg.substr(4),
+                                      settings.player[arg[2] - 'a']);
+        } else {
+            valid = ParseSearchOption(arg, settings.player[0]) &&
+                    ParseSearchOption(arg, settings.player[1]);
+        }
+
+        if (!valid) {
+            cout << "Invalid option: " << arg << "\n";
+            PrintOptions();
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]).compare(0, 11, "--selfplay=") == 0) {
+            CSelfPlaySettings match_settings;
+            if (!ParseSelfPlaySettings(argc, argv, match_settings)) {
+                return (1);
+            }
+
+            CSelfPlay match(match_settings);
+            if (!match.Run()) {
+                return (1);
+            }
+
+            cout << "A won " << match.Wins(0) << ", B won " << match.Wins(1)
+                 << ", blue won " << match.BlueWins() << " of "
+                 << match_settings.games << " games" << endl;
+            return (0);
+        }
+    }
+
+    CSearchSettings settings;
+    if (!ParseSearchSettings(argc, argv, settings)) {
+        return (1);
+    }
+
     CHexBoard HexBoard(ChooseBoardDimension());
+    HexBoard.SetSearchSettings(settings);
     HexBoard.Start();
-}
\ No newline at end of file
+}
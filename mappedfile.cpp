@@ -0,0 +1,99 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+
+#ifdef _WIN32
+
+CMappedFile::CMappedFile(const string filename)
+    : data_ptr(nullptr), data_size(0), is_open(false) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    LARGE_INTEGER file_size;
+
+    if ((file == INVALID_HANDLE_VALUE) || !GetFileSizeEx(file, &file_size)) {
+        perror("\nFile Error ");
+    } else if (file_size.QuadPart == 0) {
+        // empty files can not be mapped
+        is_open = true;
+    } else {
+        HANDLE mapping =
+            CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* p = (mapping != nullptr)
+                      ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+                      : nullptr;
+
+        if (p == nullptr) {
+            perror("\nFile Error ");
+        } else {
+            data_ptr = static_cast<const char*>(p);
+            data_size = static_cast<size_t>(file_size.QuadPart);
+            is_open = true;
+        }
+
+        // the view stays valid without the mapping handle
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+    }
+
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+}
+
+CMappedFile::~CMappedFile() {
+    if (data_ptr != nullptr) {
+        UnmapViewOfFile(data_ptr);
+    }
+}
+
+#else
+
+CMappedFile::CMappedFile(const string filename)
+    : data_ptr(nullptr), data_size(0), is_open(false) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat file_stat;
+
+    if ((fd < 0) || (fstat(fd, &file_stat) != 0)) {
+        perror("\nFile Error ");
+    } else if (file_stat.st_size == 0) {
+        // mmap refuses empty ranges
+        is_open = true;
+    } else {
+        void* p = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd,
+                       0);
+
+        if (p == MAP_FAILED) {
+            perror("\nFile Error ");
+        } else {
+            data_ptr = static_cast<const char*>(p);
+            data_size = file_stat.st_size;
+            is_open = true;
+        }
+    }
+
+    // the mapping stays valid without the descriptor
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+CMappedFile::~CMappedFile() {
+    if (data_ptr != nullptr) {
+        munmap(const_cast<char*>(data_ptr), data_size);
+    }
+}
+
+#endif
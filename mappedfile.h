@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+using namespace std;
+
+// Read only view of a whole file mapped into memory, by mmap on POSIX
+// systems and by a file mapping view on Windows.
+//
+// The pages are loaded by the operating system on first touch, so opening
+// even a large file is cheap, and the data is shared with the page cache
+// instead of being copied. The mapping lives until the object is destroyed.
+class CMappedFile {
+   private:
+    const char* data_ptr;
+    size_t data_size;
+    bool is_open;
+
+   public:
+    CMappedFile(const string filename);
+    ~CMappedFile(void);
+
+    CMappedFile(const CMappedFile&) = delete;
+    CMappedFile& operator=(const CMappedFile&) = delete;
+
+    // an empty file is open, but has no data
+    bool IsOpen(void) const { return is_open; }
+    const char* Data(void) const { return data_ptr; }
+    size_t Size(void) const { return data_size; }
+};
+
+#endif
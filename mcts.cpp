@@ -0,0 +1,288 @@
+#include "mcts.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "inferior.h"
+
+// iterations between two deadline checks, power of two
+static const int64_t DEADLINE_CHECK_INTERVAL = 32;
+
+int32_t CMCTSNodePool::Allocate(const int32_t count) {
+    if (nodes.size() + count > max_nodes) {
+        return (-1);
+    }
+
+    int32_t first = nodes.size();
+    nodes.resize(nodes.size() + count);
+    return (first);
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+// removes the cell from an unordered empty cell list
+static void RemoveEmptyCell(TVectorIDList& empty, const TVertexID id) {
+    TVectorIDList::iterator it = find(empty.begin(), empty.end(), id);
+
+    if (it != empty.end()) {
+        *it = empty.back();
+        empty.pop_back();
+    }
+}
+
+CMCTSearch::CMCTSearch(const int32_t board_width, const uint32_t node_limit,
+                       const float exploration_constant,
+                       const int32_t expand_after_visits)
+    : pool(node_limit),
+      spare_pool(node_limit),
+      root(-1),
+      root_position(board_width),
+      root_to_move(EVertextColor::vtWHITE),
+      reused_visits(0),
+      exploration(exploration_constant),
+      expand_visits(expand_after_visits),
+      transpositions(nullptr),
+      prune_inferior(false) {}
+
+void CMCTSearch::Reset(const CBitBoard& position, const TVectorIDList& empty,
+                       const EVertextColor to_move) {
+    pool.Clear();
+    root = pool.Allocate(1);
+
+    root_position = position;
+    root_empty_cells = empty;
+    root_to_move = to_move;
+}
+
+void CMCTSearch::Advance(const TVertexID move) {
+    if (root < 0) {
+        return;
+    }
+
+    // look for the played move below the root. a symmetric root has only
+    // one move of each rotated pair, the subtree of the twin is then kept
+    // with all its moves rotated
+    int32_t new_root = -1;
+    bool rotate = false;
+    for (int32_t i = 0; i < pool[root].child_count; i++) {
+        const TVertexID child_move = pool[pool[root].first_child + i].move;
+
+        if (child_move == move) {
+            new_root = pool[root].first_child + i;
+            rotate = false;
+            break;
+        }
+        if ((child_move == root_position.RotatedCell(move)) &&
+            root_position.IsSymmetric()) {
+            new_root = pool[root].first_child + i;
+            rotate = true;
+        }
+    }
+
+    // copy the subtree breadth first into the spare pool, so that children
+    // stay next to each other, then swap the pools
+    spare_pool.Clear();
+    if (new_root >= 0) {
+        vector<pair<int32_t, int32_t>> queue;  // old index, new index
+        queue.push_back(make_pair(new_root, spare_pool.Allocate(1)));
+        spare_pool[0] = pool[new_root];
+        spare_pool[0].move = move;
+
+        for (size_t q = 0; q < queue.size(); q++) {
+            const CMCTSNode& old_node = pool[queue[q].first];
+
+            if (old_node.child_count > 0) {
+                int32_t first = spare_pool.Allocate(old_node.child_count);
+                spare_pool[queue[q].second].first_child = first;
+
+                for (int32_t i = 0; i < old_node.child_count; i++) {
+                    CMCTSNode& child = spare_pool[first + i];
+                    child = pool[old_node.first_child + i];
+                    if (rotate) {
+                        child.move = root_position.RotatedCell(child.move);
+                    }
+                    queue.push_back(
+                        make_pair(old_node.first_child + i, first + i));
+                }
+            }
+        }
+    } else {
+        (void)spare_pool.Allocate(1);
+    }
+
+    swap(pool, spare_pool);
+    root = 0;
+
+    root_position.Set(move, root_to_move);
+    RemoveEmptyCell(root_empty_cells, move);
+    root_to_move = OpponentColor(root_to_move);
+}
+
+// UCT: win rate plus exploration bonus, unvisited children first. children
+// may have more visits than the node when they start with transposition
+// statistics
+int32_t CMCTSearch::SelectChild(const CMCTSNode& node) {
+    const float log_visits = log(static_cast<float>(max(node.visits, 1)));
+    int32_t best_child = node.first_child;
+    float best_value = -1.0f;
+
+    for (int32_t i = node.first_child; i < node.first_child + node.child_count;
+         i++) {
+        const CMCTSNode& child = pool[i];
+
+        if (child.visits == 0) {
+            return (i);
+        }
+
+        float value = static_cast<float>(child.wins) / child.visits +
+                      exploration * sqrt(log_visits / child.visits);
+        if (value > best_value) {
+            best_value = value;
+            best_child = i;
+        }
+    }
+
+    return (best_child);
+}
+
+void CMCTSearch::Expand(const int32_t node_index, const CBitBoard& board,
+                        const EVertextColor to_move,
+                        TRandomEngine& random_engine) {
+    // dead and captured cells are not worth a child, and a symmetric
+    // position needs only one move of each rotated pair
+    SelectCandidateMoves(board, empty_cells, prune_inferior, child_moves);
+    for (TVertexID& move : child_moves) {
+        move = empty_cells[move];
+    }
+
+    const int32_t count = static_cast<int32_t>(child_moves.size());
+    const int32_t first = pool.Allocate(count);
+
+    // pool is full, the node stays a leaf
+    if (first < 0) {
+        return;
+    }
+
+    // children in random order, so unvisited ones are tried randomly
+    shuffle(child_moves.begin(), child_moves.end(), random_engine);
+    for (int32_t i = 0; i < count; i++) {
+        CMCTSNode& child = pool[first + i];
+        child = CMCTSNode(child_moves[i]);
+
+        if (transpositions) {
+            (void)transpositions->Probe(
+                board.CanonicalHashAfter(child.move, to_move), child.visits,
+                child.wins);
+        }
+    }
+
+    pool[node_index].first_child = first;
+    pool[node_index].child_count = count;
+}
+
+void CMCTSearch::Iterate(TRandomEngine& random_engine) {
+    CBitBoard board = root_position;
+    EVertextColor to_move = root_to_move;
+    int32_t node = root;
+
+    empty_cells = root_empty_cells;
+    path.clear();
+    path_hashes.clear();
+    path.push_back(node);
+    path_hashes.push_back(board.CanonicalHash());
+
+    // selection
+    while (pool[node].child_count > 0) {
+        node = SelectChild(pool[node]);
+
+        board.Set(pool[node].move, to_move);
+        RemoveEmptyCell(empty_cells, pool[node].move);
+        to_move = OpponentColor(to_move);
+        path.push_back(node);
+        path_hashes.push_back(board.CanonicalHash());
+    }
+
+    // expansion
+    if ((pool[node].visits >= expand_visits) && !empty_cells.empty()) {
+        Expand(node, board, to_move, random_engine);
+
+        if (pool[node].child_count > 0) {
+            node = pool[node].first_child;
+
+            board.Set(pool[node].move, to_move);
+            RemoveEmptyCell(empty_cells, pool[node].move);
+            to_move = OpponentColor(to_move);
+            path.push_back(node);
+            path_hashes.push_back(board.CanonicalHash());
+        }
+    }
+
+    // simulation
+    EVertextColor winner =
+        playout.Winner(board, empty_cells, to_move, random_engine);
+
+    // backpropagation, the root was reached by the opponent of root_to_move
+    EVertextColor mover = OpponentColor(root_to_move);
+    for (size_t i = 0; i < path.size(); i++) {
+        CMCTSNode& n = pool[path[i]];
+        const int32_t win = (winner == mover) ? 1 : 0;
+
+        n.visits++;
+        n.wins += win;
+        if (transpositions) {
+            transpositions->Add(path_hashes[i], 1, win);
+        }
+        mover = OpponentColor(mover);
+    }
+}
+
+TVertexID CMCTSearch::Search(const CBitBoard& position,
+                             const TVectorIDList& empty,
+                             const EVertextColor to_move,
+                             const int64_t iterations,
+                             TRandomEngine& random_engine,
+                             const CSearchDeadline& deadline) {
+    if ((root < 0) || !(root_position == position) ||
+        (root_to_move != to_move)) {
+        Reset(position, empty, to_move);
+    }
+    reused_visits = pool[root].visits;
+
+    if (pool[root].child_count == 0) {
+        empty_cells = root_empty_cells;
+        Expand(root, root_position, root_to_move, random_engine);
+    }
+
+    for (int64_t i = 0; i < iterations; i++) {
+        // clock is read once per a few dozen playouts only
+        if (((i & (DEADLINE_CHECK_INTERVAL - 1)) == 0) && deadline.Expired()) {
+            break;
+        }
+
+        Iterate(random_engine);
+    }
+
+    // most visited child is the most robust choice
+    TVertexID best_move = root_empty_cells[0];
+    int32_t best_visits = -1;
+    for (int32_t i = 0; i < pool[root].child_count; i++) {
+        const CMCTSNode& child = pool[pool[root].first_child + i];
+
+        if (child.visits > best_visits) {
+            best_visits = child.visits;
+            best_move = child.move;
+        }
+    }
+
+    return (best_move);
+}
+
+void CMCTSearch::RootChildren(vector<CMCTSNode>& children) {
+    children.clear();
+
+    if (root >= 0) {
+        for (int32_t i = 0; i < pool[root].child_count; i++) {
+            children.push_back(pool[pool[root].first_child + i]);
+        }
+    }
+}
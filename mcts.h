@@ -0,0 +1,139 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <cstdint>  // for platform independent types
+#include <vector>
+using namespace std;
+
+#include "bitboard.h"
+#include "deadline.h"
+#include "playout.h"
+#include "transposition.h"
+
+// one position of the search tree, children are stored next to each other
+// in the node pool
+class CMCTSNode {
+   public:
+    TVertexID move;  // the move which leads to this node
+    int32_t first_child;
+    int32_t child_count;
+    int32_t visits;
+    int32_t wins;  // wins of the player who played move
+
+    CMCTSNode(const TVertexID m = -1)
+        : move(m), first_child(-1), child_count(0), visits(0), wins(0) {}
+};
+
+// Node pool allocator, nodes live in one vector and are addressed by index,
+// so growing the pool never invalidates the tree links.
+class CMCTSNodePool {
+   private:
+    vector<CMCTSNode> nodes;
+    uint32_t max_nodes;
+
+   public:
+    CMCTSNodePool(const uint32_t node_limit) : max_nodes(node_limit) {}
+
+    // allocates count consecutive nodes and returns the index of the first
+    // one, or -1 if the pool limit is reached
+    int32_t Allocate(const int32_t count);
+    void Clear(void) { nodes.clear(); }
+
+    uint32_t Size(void) const { return nodes.size(); }
+    CMCTSNode& operator[](const int32_t index) { return nodes[index]; }
+};
+
+// Monte Carlo Tree Search with UCT selection.
+//
+// The tree is kept between searches. Every move played on the board has to be
+// passed to Advance(), which keeps the subtree below that move as the new
+// root and drops the rest of the tree.
+//
+// With a transposition table every playout result is also added to the
+// table entry of each position on its path, and new nodes start with the
+// statistics the table has for their position. So a position reached by
+// another move order, or searched in an earlier turn and dropped with its
+// tree, is not evaluated from scratch again.
+class CMCTSearch {
+   private:
+    // trees are compacted into the spare pool on Advance(), then swapped
+    CMCTSNodePool pool;
+    CMCTSNodePool spare_pool;
+    int32_t root;
+
+    CBitBoard root_position;
+    TVectorIDList root_empty_cells;
+    EVertextColor root_to_move;
+
+    // root visits the last search started with
+    int32_t reused_visits;
+
+    float exploration;
+    int32_t expand_visits;
+
+    CPlayout playout;
+
+    // not owned, may be shared with other searches
+    CTranspositionTable* transpositions;
+
+    // scratch data of one iteration, path_hashes are the canonical position
+    // hashes of the path nodes
+    vector<int32_t> path;
+    vector<uint64_t> path_hashes;
+    TVectorIDList empty_cells;
+    TVectorIDList child_moves;
+
+    // dead and captured cells get no node (see inferior.h)
+    bool prune_inferior;
+
+    int32_t SelectChild(const CMCTSNode& node);
+
+    // adds the empty cells as children of the node whose position is board,
+    // only one of each rotated pair if the position is symmetric and none
+    // of the pruned inferior cells
+    void Expand(const int32_t node_index, const CBitBoard& board,
+                const EVertextColor to_move, TRandomEngine& random_engine);
+    void Iterate(TRandomEngine& random_engine);
+
+   public:
+    CMCTSearch(const int32_t board_width = 11,
+               const uint32_t node_limit = 2000000,
+               const float exploration_constant = 0.7f,
+               const int32_t expand_after_visits = 3);
+
+    // starts a new tree for the position
+    void Reset(const CBitBoard& position, const TVectorIDList& empty,
+               const EVertextColor to_move);
+
+    // follows the move played on the board, keeping its subtree
+    void Advance(const TVertexID move);
+
+    // runs the given number of iterations, or less if the deadline comes
+    // first, and returns the most visited move. if position is not the one
+    // the tree was advanced to, the tree is reset
+    TVertexID Search(const CBitBoard& position, const TVectorIDList& empty,
+                     const EVertextColor to_move, const int64_t iterations,
+                     TRandomEngine& random_engine,
+                     const CSearchDeadline& deadline = CSearchDeadline());
+
+    CPlayout& Playout(void) { return playout; }
+
+    void SetInferiorPruning(const bool on) { prune_inferior = on; }
+
+    // nullptr searches without a transposition table
+    void SetTranspositionTable(CTranspositionTable* table) {
+        transpositions = table;
+    }
+
+    // copies of the children of the root, empty if there is no tree
+    void RootChildren(vector<CMCTSNode>& children);
+
+    uint32_t TreeSize(void) const { return pool.Size(); }
+    int32_t RootVisits(void) { return (root < 0 ? 0 : pool[root].visits); }
+
+    // playouts the last Search() found below its position, from earlier
+    // searches and pondering. 0 if it had to reset the tree
+    int32_t ReusedVisits(void) const { return reused_visits; }
+};
+
+#endif
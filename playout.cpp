@@ -0,0 +1,250 @@
+#include "playout.h"
+
+#include "inferior.h"
+
+int32_t CPlayout::Run(const CBitBoard& position,
+                      const TVectorIDList& empty_cells,
+                      const int32_t candidate_inx, const EVertextColor mover,
+                      int32_t sim_count, TRandomEngine& random_engine,
+                      CAmafStatistics* amaf) {
+    if (!fill_captured) {
+        return (RunPlayouts(position, empty_cells, candidate_inx, mover,
+                            sim_count, random_engine, amaf));
+    }
+
+    // captures after the candidate move, the candidate itself stays empty
+    // so that the playouts place it as usual
+    const TVertexID candidate = empty_cells[candidate_inx];
+    captured_position = position;
+    captured_position.Set(candidate, mover);
+    (void)FillCapturedCells(captured_position);
+    captured_position.Set(candidate, EVertextColor::vtWHITE);
+
+    int32_t captured_inx = 0;
+    captured_empty_cells.clear();
+    for (const TVertexID id : empty_cells) {
+        if (id == candidate) {
+            captured_inx = static_cast<int32_t>(captured_empty_cells.size());
+        }
+        if (captured_position.Get(id) == EVertextColor::vtWHITE) {
+            captured_empty_cells.push_back(id);
+        }
+    }
+
+    return (RunPlayouts(captured_position, captured_empty_cells, captured_inx,
+                        mover, sim_count, random_engine, amaf));
+}
+
+int32_t CPlayout::RunPlayouts(const CBitBoard& position,
+                              const TVectorIDList& empty_cells,
+                              const int32_t candidate_inx,
+                              const EVertextColor mover, int32_t sim_count,
+                              TRandomEngine& random_engine,
+                              CAmafStatistics* amaf) {
+    if (mode == EPlayoutMode::pmEARLY_STOP) {
+        return (RunEarlyStop(position, empty_cells, candidate_inx, mover,
+                             sim_count, random_engine, amaf));
+    }
+
+    if ((mode == EPlayoutMode::pmBATCH) && !amaf) {
+        return (batch.Run(position, empty_cells, candidate_inx, mover,
+                          sim_count, random_engine, counters, timing));
+    }
+
+    int32_t winner_count = 0;
+
+    // rest of the empty places as bit positions
+    fill_bits.clear();
+    fill_ids.clear();
+    for (int32_t i = 0; i != static_cast<int32_t>(empty_cells.size()); i++) {
+        if (i != candidate_inx) {
+            fill_bits.push_back(position.BitIndex(empty_cells[i]));
+            fill_ids.push_back(empty_cells[i]);
+        }
+    }
+
+    const int32_t fill_count = static_cast<int32_t>(fill_bits.size());
+
+    // players alternate and the opponent moves first after the candidate,
+    // so the mover gets the smaller half of the rest
+    const int32_t mover_count = fill_count / 2;
+
+    TBitBoardBits base = position.Bits(mover);
+    SetBoardBit(base, position.BitIndex(empty_cells[candidate_inx]));
+
+    counters.playouts += sim_count;
+
+    while (sim_count-- > 0) {
+        CPhaseClock clock(timing);
+        TBitBoardBits stones = base;
+        clock.Lap(counters.reset_time);
+
+        // partial Fisher-Yates shuffle, only the mover's part is needed
+        for (int32_t i = 0; i < mover_count; i++) {
+            uniform_int_distribution<int32_t> pick(i, fill_count - 1);
+            const int32_t j = pick(random_engine);
+            swap(fill_bits[i], fill_bits[j]);
+            if (amaf) {
+                swap(fill_ids[i], fill_ids[j]);
+            }
+            SetBoardBit(stones, fill_bits[i]);
+        }
+        clock.Lap(counters.fill_time);
+
+        const bool win = position.Connects(stones, mover);
+        if (win) {
+            ++winner_count;
+        }
+        clock.Lap(counters.detect_time);
+
+        if (amaf) {
+            amaf->Add(empty_cells[candidate_inx], win);
+            for (int32_t i = 0; i < mover_count; i++) {
+                amaf->Add(fill_ids[i], win);
+            }
+        }
+    }
+
+    return (winner_count);
+}
+
+EVertextColor CPlayout::PlayUntilConnected(const int32_t width,
+                                           const EVertextColor to_move,
+                                           TRandomEngine& random_engine) {
+    const int32_t fill_count = static_cast<int32_t>(fill_cells.size());
+    EVertextColor player = to_move;
+    CPhaseClock clock(timing);
+
+    counters.playouts++;
+    groups.Restore(base_groups);
+    clock.Lap(counters.reset_time);
+
+    for (int32_t i = 0; i < fill_count; i++) {
+        // next stone is picked like in a shuffle, one step at a time
+        uniform_int_distribution<int32_t> pick(i, fill_count - 1);
+        swap(fill_cells[i], fill_cells[pick(random_engine)]);
+
+        // only a stone which joins groups can complete a connection
+        bool connected =
+            groups.SetColor(fill_cells[i], player) &&
+            ((player == EVertextColor::vtRED)
+                 ? groups.Connected(HexEdgeVertex(width, EHexEdge::heLEFT),
+                                    HexEdgeVertex(width, EHexEdge::heRIGHT))
+                 : groups.Connected(HexEdgeVertex(width, EHexEdge::heTOP),
+                                    HexEdgeVertex(width, EHexEdge::heBOTTOM)));
+        if (connected) {
+            clock.Lap(counters.detect_time);
+            placed_count = i + 1;
+            counters.placed_stones += i + 1;
+            counters.skipped_stones += fill_count - (i + 1);
+            return (player);
+        }
+
+        player = OpponentColor(player);
+    }
+
+    clock.Lap(counters.detect_time);
+    placed_count = fill_count;
+
+    // only possible if the position has no empty cell, then the filled
+    // board is decided by one flood fill
+    return (groups.Connected(HexEdgeVertex(width, EHexEdge::heLEFT),
+                             HexEdgeVertex(width, EHexEdge::heRIGHT))
+                ? EVertextColor::vtRED
+                : EVertextColor::vtBLUE);
+}
+
+int32_t CPlayout::RunEarlyStop(const CBitBoard& position,
+                               const TVectorIDList& empty_cells,
+                               const int32_t candidate_inx,
+                               const EVertextColor mover, int32_t sim_count,
+                               TRandomEngine& random_engine,
+                               CAmafStatistics* amaf) {
+    int32_t winner_count = 0;
+
+    // groups of the position after the candidate move, copied per playout
+    CBitBoard after_candidate = position;
+    after_candidate.Set(empty_cells[candidate_inx], mover);
+    base_groups = CColorConnectivity(after_candidate);
+
+    fill_cells.clear();
+    for (int32_t i = 0; i != static_cast<int32_t>(empty_cells.size()); i++) {
+        if (i != candidate_inx) {
+            fill_cells.push_back(empty_cells[i]);
+        }
+    }
+
+    // candidate may already connect
+    if (after_candidate.IsWinner(mover)) {
+        counters.playouts += sim_count;
+        if (amaf) {
+            amaf->playouts[empty_cells[candidate_inx]] += sim_count;
+            amaf->wins[empty_cells[candidate_inx]] += sim_count;
+        }
+        return (sim_count);
+    }
+
+    while (sim_count-- > 0) {
+        const bool win = (PlayUntilConnected(position.Width(),
+                                              OpponentColor(mover),
+                                              random_engine) == mover);
+        if (win) {
+            ++winner_count;
+        }
+
+        // the opponent placed first, so the mover's stones are the odd ones
+        if (amaf) {
+            amaf->Add(empty_cells[candidate_inx], win);
+            for (int32_t i = 1; i < placed_count; i += 2) {
+                amaf->Add(fill_cells[i], win);
+            }
+        }
+    }
+
+    return (winner_count);
+}
+
+EVertextColor CPlayout::Winner(const CBitBoard& position,
+                               const TVectorIDList& empty_cells,
+                               const EVertextColor to_move,
+                               TRandomEngine& random_engine) {
+    if (mode == EPlayoutMode::pmEARLY_STOP) {
+        // position may already be decided by the tree moves
+        if (position.IsWinner(OpponentColor(to_move))) {
+            counters.playouts++;
+            return (OpponentColor(to_move));
+        }
+
+        base_groups = CColorConnectivity(position);
+        fill_cells = empty_cells;
+        return (PlayUntilConnected(position.Width(), to_move, random_engine));
+    }
+
+    CPhaseClock clock(timing);
+
+    counters.playouts++;
+    fill_bits.clear();
+    for (const TVertexID id : empty_cells) {
+        fill_bits.push_back(position.BitIndex(id));
+    }
+
+    const int32_t fill_count = static_cast<int32_t>(fill_bits.size());
+
+    // to_move places first, so it gets the bigger half
+    const int32_t mover_count = (fill_count + 1) / 2;
+
+    TBitBoardBits stones = position.Bits(to_move);
+    clock.Lap(counters.reset_time);
+
+    for (int32_t i = 0; i < mover_count; i++) {
+        uniform_int_distribution<int32_t> pick(i, fill_count - 1);
+        swap(fill_bits[i], fill_bits[pick(random_engine)]);
+        SetBoardBit(stones, fill_bits[i]);
+    }
+    clock.Lap(counters.fill_time);
+
+    const bool connects = position.Connects(stones, to_move);
+    clock.Lap(counters.detect_time);
+
+    return (connects ? to_move : OpponentColor(to_move));
+}
@@ -0,0 +1,142 @@
+#ifndef PLAYOUT_H
+#define PLAYOUT_H
+
+#include <cstdint>  // for platform independent types
+#include <random>
+#include <vector>
+using namespace std;
+
+#include "batchplayout.h"
+#include "bitboard.h"
+#include "connectivity.h"
+#include "telemetry.h"
+
+// how a playout finds its winner
+enum class EPlayoutMode : uint8_t {
+    // fill the whole board, then flood fill once
+    pmFULL_FILL,
+    // place stones one by one with union-find and stop at the first
+    // connection
+    pmEARLY_STOP,
+    // full fill, CBatchPlayout::BatchSize playouts at once
+    pmBATCH
+};
+
+// All moves as first statistics: every playout counts for each empty cell
+// the mover has a stone on at the end, as if the mover had played it first.
+// Indexed by vertex id.
+class CAmafStatistics {
+   public:
+    vector<int32_t> playouts;
+    vector<int32_t> wins;
+
+    void Reset(const size_t cell_count) {
+        playouts.assign(cell_count, 0);
+        wins.assign(cell_count, 0);
+    }
+
+    void Add(const TVertexID id, const bool win) {
+        playouts[id]++;
+        wins[id] += win ? 1 : 0;
+    }
+};
+
+// Monte Carlo playout engine working on packed positions
+//
+// The board is filled until there is no empty place left, and since there is
+// no draw in hex, only the stones of the mover decide the result. Therefore a
+// playout just drops the mover's share of the remaining stones on random
+// empty places and flood fills the mover's color once.
+//
+// In early stop mode the stones are placed in playing order and the groups are
+// joined as they are placed. The first connection decides the game, so the
+// playout stops there; the result is the same as the one of the full fill.
+//
+// With AMAF statistics a full fill credits every cell of the mover, an early
+// stop playout the mover's cells placed up to the connection. Batch mode
+// plays full fills one by one then, since its lanes do not keep their cells.
+class CPlayout {
+   private:
+    EPlayoutMode mode;
+
+    // scratch list of bit positions, kept to avoid allocations per call.
+    // fill_ids are their vertex ids, only kept for AMAF
+    vector<int32_t> fill_bits;
+    TVectorIDList fill_ids;
+
+    // scratch data of early stop mode
+    TVectorIDList fill_cells;
+    CColorConnectivity base_groups;
+    CColorConnectivity groups;
+
+    // stones placed by the last PlayUntilConnected()
+    int32_t placed_count;
+
+    // position with its captured cells filled, and the cells left empty
+    bool fill_captured;
+    CBitBoard captured_position;
+    TVectorIDList captured_empty_cells;
+
+    CPlayoutCounters counters;
+    bool timing;
+
+    // engine of batch mode
+    CBatchPlayout batch;
+
+    // plays the rest of fill_cells in random order, first stone is for
+    // to_move. returns the color which connects first
+    EVertextColor PlayUntilConnected(const int32_t width,
+                                     const EVertextColor to_move,
+                                     TRandomEngine& random_engine);
+
+    // Run() without filling captured cells
+    int32_t RunPlayouts(const CBitBoard& position,
+                        const TVectorIDList& empty_cells,
+                        const int32_t candidate_inx, const EVertextColor mover,
+                        int32_t sim_count, TRandomEngine& random_engine,
+                        CAmafStatistics* amaf);
+
+    int32_t RunEarlyStop(const CBitBoard& position,
+                         const TVectorIDList& empty_cells,
+                         const int32_t candidate_inx,
+                         const EVertextColor mover, int32_t sim_count,
+                         TRandomEngine& random_engine, CAmafStatistics* amaf);
+
+   public:
+    CPlayout(const EPlayoutMode m = EPlayoutMode::pmFULL_FILL)
+        : mode(m), placed_count(0), fill_captured(false), timing(false) {}
+
+    EPlayoutMode Mode(void) const { return mode; }
+    void SetMode(const EPlayoutMode m) { mode = m; }
+
+    const CPlayoutCounters& Counters(void) const { return counters; }
+    void ResetCounters(void) { counters = CPlayoutCounters(); }
+
+    // measures the time of the playout phases, off by default
+    void SetTiming(const bool on) { timing = on; }
+
+    // Run() fills the captured cells (see inferior.h) of the position after
+    // the candidate once, they decide no fill, so the playouts only shuffle
+    // the cells which matter. Winner() plays a single playout, for which the
+    // analysis would cost more than it saves
+    void SetFillCaptured(const bool on) { fill_captured = on; }
+
+    // plays empty_cells[candidate_inx] for mover, then fills the rest of the
+    // empty cells randomly sim_count times, starting with the opponent.
+    // returns how many of those playouts mover has won. amaf, if given, has
+    // to be sized to the board cells and gets the results added
+    int32_t Run(const CBitBoard& position, const TVectorIDList& empty_cells,
+                const int32_t candidate_inx, const EVertextColor mover,
+                int32_t sim_count, TRandomEngine& random_engine,
+                CAmafStatistics* amaf = nullptr);
+
+    // fills all empty cells randomly once, players alternate starting with
+    // to_move. returns the winner of the filled board. a single playout is
+    // no batch, so batch mode plays it as a full fill
+    EVertextColor Winner(const CBitBoard& position,
+                         const TVectorIDList& empty_cells,
+                         const EVertextColor to_move,
+                         TRandomEngine& random_engine);
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef RADIXHEAP_H
+#define RADIXHEAP_H
+
+#include <algorithm>
+#include <cstdint>  // for platform independent types
+#include <utility>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+using namespace std;
+
+// Monotone priority queue on 32 bit keys.
+//
+// Every pushed key must be at least the key popped last, which holds for
+// Dijkstra's algorithm. Bucket i holds the keys that first differ from the
+// last popped key in bit i - 1, so an element moves to a lower bucket at most
+// 32 times, and push is a plain append. Buckets keep their capacity after
+// Clear().
+template <typename TValue>
+class CRadixHeap {
+   private:
+    typedef pair<uint32_t, TValue> TEntry;
+
+    vector<TEntry> buckets[33];
+    uint32_t last_key;
+    size_t count;
+
+    // one more than the index of the highest bit where key and last differ
+    static int32_t BucketOf(const uint32_t key, const uint32_t last) {
+        if (key == last) {
+            return (0);
+        }
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse(&index, key ^ last);
+        return (int32_t(index) + 1);
+#else
+        return (32 - __builtin_clz(key ^ last));
+#endif
+    }
+
+   public:
+    CRadixHeap() : last_key(0), count(0) {}
+
+    void Clear(void) {
+        for (vector<TEntry>& b : buckets) {
+            b.clear();
+        }
+        last_key = 0;
+        count = 0;
+    }
+
+    bool Empty(void) const { return (count == 0); }
+
+    void Push(const uint32_t key, const TValue& value) {
+        buckets[BucketOf(key, last_key)].push_back(make_pair(key, value));
+        count++;
+    }
+
+    // removes an entry with the smallest key
+    TEntry Pop(void) {
+        if (buckets[0].empty()) {
+            int32_t i = 1;
+            while (buckets[i].empty()) {
+                i++;
+            }
+
+            // the smallest key of the first non-empty bucket becomes the new
+            // last key, the rest of that bucket spreads over lower buckets
+            last_key = min_element(buckets[i].begin(), buckets[i].end())->first;
+            for (const TEntry& e : buckets[i]) {
+                buckets[BucketOf(e.first, last_key)].push_back(e);
+            }
+            buckets[i].clear();
+        }
+
+        TEntry top = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return (top);
+    }
+};
+
+#endif
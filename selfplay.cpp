@@ -0,0 +1,131 @@
+#include "selfplay.h"
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+string CSelfPlayGame::Json() const {
+    ostringstream out;
+
+    out << "{\"game\":" << index << ",\"seed\":" << seed
+        << ",\"board\":" << board_size << ",\"blue\":\""
+        << (blue_player == 0 ? "A" : "B") << "\",\"winner\":\""
+        << (winner == EVertextColor::vtBLUE ? "blue" : "red")
+        << "\",\"moves\":[";
+
+    for (size_t i = 0; i < moves.size(); i++) {
+        out << (i ? "," : "") << "\"" << moves[i] << "\"";
+    }
+
+    out << "],\"seconds\":[";
+    for (size_t i = 0; i < move_seconds.size(); i++) {
+        out << (i ? "," : "") << move_seconds[i];
+    }
+    out << "]}";
+
+    return (out.str());
+}
+
+CSelfPlay::CSelfPlay(const CSelfPlaySettings& match_settings)
+    : settings(match_settings), pool(match_settings.threads), blue_wins(0) {
+    wins[0] = 0;
+    wins[1] = 0;
+
+    for (CSearchSettings& s : settings.player) {
+        s.threads = 1;
+        s.ponder = false;
+        s.stats = false;
+    }
+}
+
+void CSelfPlay::PlayGame(const int32_t index, CSelfPlayGame& game) {
+    seed_seq game_seed_seq = {settings.seed, static_cast<uint32_t>(index)};
+    uint32_t game_seed;
+    game_seed_seq.generate(&game_seed, &game_seed + 1);
+    TRandomEngine random_engine(game_seed);
+
+    game.index = index;
+    game.seed = game_seed;
+    game.board_size = settings.board_sizes[index % settings.board_sizes.size()];
+    game.blue_player = (settings.swap_sides ? index % 2 : 0);
+    game.moves.clear();
+    game.move_seconds.clear();
+
+    // boards and settings are indexed by color, blue first
+    const CSearchSettings* side_settings[2] = {
+        &settings.player[game.blue_player],
+        &settings.player[1 - game.blue_player]};
+    CHexBoard blue_board(game.board_size);
+    CHexBoard red_board(game.board_size);
+    CHexBoard* boards[2] = {&blue_board, &red_board};
+
+    blue_board.SetSearchSettings(*side_settings[0]);
+    red_board.SetSearchSettings(*side_settings[1]);
+    blue_board.Seed(random_engine());
+    red_board.Seed(random_engine());
+
+    bool won = false;
+    int32_t mover = 0;
+
+    while (!won) {
+        CHexBoard& board = *boards[mover];
+        const TVectorIDList& empty_cells = board.EmptyCells();
+        TVertexID move;
+        double seconds = 0.0;
+
+        if (static_cast<int32_t>(game.moves.size()) < settings.opening_moves) {
+            uniform_int_distribution<size_t> pick(0, empty_cells.size() - 1);
+            move = empty_cells[pick(random_engine)];
+        } else {
+            steady_clock::time_point start = steady_clock::now();
+            move = board.SearchMove(
+                milliseconds(side_settings[mover]->think_time));
+            seconds = duration<double>(steady_clock::now() - start).count();
+        }
+
+        game.moves.push_back(board.VertextIDToCoordStr(move));
+        game.move_seconds.push_back(seconds);
+
+        // both boards follow every move
+        won = blue_board.Play(move);
+        (void)red_board.Play(move);
+
+        if (!won) {
+            mover = 1 - mover;
+        }
+    }
+
+    game.winner = (mover == 0 ? EVertextColor::vtBLUE : EVertextColor::vtRED);
+}
+
+bool CSelfPlay::Run() {
+    results.open(settings.results_file, ios::app);
+
+    if (!results.is_open()) {
+        perror("\nFile Error ");
+        return (false);
+    }
+
+    // one scratch game per worker
+    vector<CSelfPlayGame> worker_games(pool.NumberOfThreads());
+
+    pool.Run(settings.games, [&](const uint32_t worker, const uint32_t task) {
+        CSelfPlayGame& game = worker_games[worker];
+        PlayGame(static_cast<int32_t>(task), game);
+
+        const bool blue_won = (game.winner == EVertextColor::vtBLUE);
+        wins[blue_won ? game.blue_player : 1 - game.blue_player]++;
+        if (blue_won) {
+            blue_wins++;
+        }
+
+        lock_guard<mutex> lock(results_mutex);
+        results << game.Json() << endl;
+        cout << "Game " << game.index << ": "
+             << (blue_won ? "blue" : "red") << " wins in "
+             << game.moves.size() << " moves" << endl;
+    });
+
+    results.close();
+    return (true);
+}
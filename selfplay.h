@@ -0,0 +1,104 @@
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include <atomic>
+#include <cstdint>  // for platform independent types
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "hexboard.h"
+#include "threadpool.h"
+
+// tells how an engine match is played
+class CSelfPlaySettings {
+   public:
+    int32_t games;
+
+    // games cycle through the sizes, game i is played on
+    // board_sizes[i % board_sizes.size()]
+    vector<int32_t> board_sizes;
+
+    // search settings of the players A and B. their thread counts are
+    // ignored, the games run in parallel and every search is single threaded
+    CSearchSettings player[2];
+
+    // random moves played before the engines take over, so that the games
+    // do not all repeat the same opening
+    int32_t opening_moves;
+
+    // A plays blue, which moves first, in even games and red in odd ones.
+    // without swapping A always plays blue
+    bool swap_sides;
+
+    // game i is seeded from seed and i only, so any game can be replayed on
+    // its own. searches limited by time instead of level are not repeatable
+    uint32_t seed;
+
+    // games played at once, 0 means one per core
+    uint32_t threads;
+
+    // one JSON line per game, written when the game is over
+    string results_file;
+
+    CSelfPlaySettings()
+        : games(100),
+          board_sizes(1, 11),
+          opening_moves(2),
+          swap_sides(true),
+          seed(1),
+          threads(0),
+          results_file("selfplay.jsonl") {}
+};
+
+// one finished game
+class CSelfPlayGame {
+   public:
+    int32_t index;
+    uint32_t seed;
+    int32_t board_size;
+
+    // player index of blue, 0 for A and 1 for B
+    int32_t blue_player;
+
+    EVertextColor winner;
+    vector<string> moves;
+
+    // search time of every move, 0 for the random opening moves
+    vector<double> move_seconds;
+
+    string Json(void) const;
+};
+
+// Headless engine match. Games are the tasks of a thread pool and each of
+// them plays two CHexBoard instances against each other, one per player, so
+// that every engine keeps its own tree and random engine. Finished games are
+// appended to the results file at once, so the file grows while the match
+// runs and a cancelled match keeps the games played so far.
+class CSelfPlay {
+   private:
+    CSelfPlaySettings settings;
+    CThreadPool pool;
+
+    mutex results_mutex;
+    ofstream results;
+
+    // wins of A and B, and of blue
+    atomic<int32_t> wins[2];
+    atomic<int32_t> blue_wins;
+
+    void PlayGame(const int32_t index, CSelfPlayGame& game);
+
+   public:
+    CSelfPlay(const CSelfPlaySettings& match_settings);
+
+    // plays all games, returns false if the results file can not be opened
+    bool Run(void);
+
+    int32_t Wins(const int32_t player) const { return wins[player]; }
+    int32_t BlueWins(void) const { return blue_wins; }
+};
+
+#endif
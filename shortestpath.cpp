@@ -1,23 +1,13 @@
 #include "shortestpath.h"
 
-#include <limits>
-#include <queue>
-#include <set>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
 
-// this is kind of linked list to store internal data required by shortest path
-// algorithms
-class CShortestPathData {
-   public:
-    float dist;
-    bool visited;
-    TVertexID previous;
-    explicit CShortestPathData()
-        : dist(numeric_limits<float>::infinity()),
-          visited(false),
-          previous(numeric_limits<int32_t>::min()) {}
-};
+#include "unionfind.h"
 
-// Minimum Heap Implementation using priority_queue
+// Minimum Heap Implementation on the workspace heap vector
 typedef pair<TVertexID, float> TMinHeapPair;
 class CMinHeapPairComparator {
    public:
@@ -26,90 +16,567 @@ class CMinHeapPairComparator {
         return (x.second > y.second);
     }
 };
-typedef priority_queue<TMinHeapPair, vector<TMinHeapPair>,
-                       CMinHeapPairComparator>
-    TMinHeap;
 
-// Dijkstra's_algorithm based on Pseudo code at wiki-pedia:
-// http://en.wikipedia.org/wiki/Dijkstra's_algorithm
-//
-bool CShortestPath::DijkstraShortestPath(const TVertexID from_index,
-                                         const TVertexID to_index) {
+void CShortestPath::RefreshAdjacency() {
+    if (!adjacency_built || (adjacency_version != graph.Version())) {
+        adjacency = CGraphCSR(graph);
+        adjacency_version = graph.Version();
+        adjacency_built = true;
+
+        ChooseKernel();
+    }
+}
+
+// one pass over the weights tells which kernels are exact for them
+void CShortestPath::ChooseKernel() {
+    bool same_weights = true;
+    bool small_integers = true;
+    bool non_negative = true;
+
+    unit_weight = (adjacency.NumberOfArcs() > 0) ? adjacency.Weight(0) : 1.0f;
+    max_bucket_weight = 0;
+
+    for (uint32_t i = 0; i < adjacency.NumberOfArcs(); i++) {
+        const float w = adjacency.Weight(i);
+
+        // also false for NaN
+        if (!(w >= 0.0f) || isinf(w)) {
+            non_negative = false;
+            small_integers = false;
+        } else if ((w != floor(w)) || (w > MaxBucketWeight)) {
+            small_integers = false;
+        } else {
+            max_bucket_weight = max(max_bucket_weight, uint32_t(w));
+        }
+
+        same_weights = same_weights && (w == unit_weight);
+    }
+    same_weights = same_weights && non_negative;
+
+    kernel = EShortestPathKernel::spkBINARY_HEAP;
+    switch (kernel_setting) {
+        case EShortestPathKernel::spkAUTO:
+            if (same_weights) {
+                kernel = EShortestPathKernel::spkUNIT;
+            } else if (small_integers) {
+                kernel = EShortestPathKernel::spkBUCKET;
+            } else if (non_negative) {
+                kernel = EShortestPathKernel::spkRADIX_HEAP;
+            }
+            break;
+        case EShortestPathKernel::spkUNIT:
+            if (same_weights) {
+                kernel = kernel_setting;
+            }
+            break;
+        case EShortestPathKernel::spkBUCKET:
+            if (small_integers) {
+                kernel = kernel_setting;
+            }
+            break;
+        case EShortestPathKernel::spkRADIX_HEAP:
+            if (non_negative) {
+                kernel = kernel_setting;
+            }
+            break;
+        case EShortestPathKernel::spkBINARY_HEAP:
+            break;
+    }
+}
+
+void CShortestPath::SetKernel(const EShortestPathKernel k) {
+    kernel_setting = k;
+    if (adjacency_built) {
+        ChooseKernel();
+    }
+}
+
+EShortestPathKernel CShortestPath::Kernel() {
+    RefreshAdjacency();
+    return (kernel);
+}
+
+// non-negative floats keep their order as unsigned integers, -0.0 is mapped
+// to 0.0 first
+static uint32_t FloatKey(float f) {
+    uint32_t key;
+    f += 0.0f;
+    memcpy(&key, &f, sizeof(key));
+    return (key);
+}
+
+bool CShortestPath::StartQuery(const TVertexID source,
+                               const TVertexID target) {
     TargetReached = false;
     ShortestPath.clear();
     TotalDistance = 0.0f;
+    ExpandedVertices = 0;
+    counters.queries++;
 
     // source and target vertices color have to be same!
-    if (graph.GetVertex(from_index).Color == graph.GetVertex(to_index).Color) {
-        TMinHeap Q;
-        vector<CShortestPathData> dijkstra_data(graph.NumberOfVertices());
-
-        dijkstra_data[from_index].dist =
-            0.0f;  // Distance from source to source
-        Q.push(make_pair(from_index,
-                         dijkstra_data[from_index]
-                             .dist));  // Start off with just the source node
-
-        while (!Q.empty() && !TargetReached) {
-            // pop the min distance element
-            TVertexID u_index = Q.top().first;
-            CShortestPathData* u = &dijkstra_data[u_index];
-            Q.pop();
-
-            // mark this node as visited
-            u->visited = true;
-
-            // check whether we reached the target
-            if (u_index == to_index) {
-                // Now we can read the shortest path from source to target by
-                // reverse iteration
-                TargetReached = true;
-                TotalDistance = u->dist;
+    if (graph.GetVertex(source).Color != graph.GetVertex(target).Color) {
+        return (false);
+    }
+
+    RefreshAdjacency();
+    workspace.Reset(graph.NumberOfVertices());
+
+    // Distance from source to source
+    workspace.Reach(source, 0.0f, -1);
+    return (true);
+}
+
+bool CShortestPath::FinishQuery() {
+    counters.expanded_vertices += ExpandedVertices;
+    return (TargetReached);
+}
+
+bool CShortestPath::DijkstraShortestPath(const TVertexID from_index,
+                                         const TVertexID to_index) {
+    if (StartQuery(from_index, to_index)) {
+        switch (kernel) {
+            case EShortestPathKernel::spkUNIT:
+                UnitWeightSearch(from_index, to_index);
+                break;
+            case EShortestPathKernel::spkBUCKET:
+                BucketSearch(from_index, to_index);
+                break;
+            case EShortestPathKernel::spkRADIX_HEAP:
+                RadixHeapSearch(from_index, to_index);
+                break;
+            default:
+                BinaryHeapSearch(from_index, to_index);
+                break;
+        }
+    }
+
+    return (FinishQuery());
+}
+
+bool CShortestPath::BidirectionalShortestPath(const TVertexID from_index,
+                                              const TVertexID to_index) {
+    if (!StartQuery(from_index, to_index)) {
+        return (false);
+    }
 
-                ShortestPath.push_front(
-                    &graph.GetVertex(u_index));  // add target first
-                while (u->previous >= 0) {
-                    ShortestPath.push_front(&graph.GetVertex(u->previous));
-                    u = &dijkstra_data[u->previous];
+    const EVertextColor source_color = graph.GetVertex(from_index).Color;
+    CShortestPathWorkspace* side[2] = {&workspace, &backward_workspace};
+    CMinHeapPairComparator comparator;
+
+    backward_workspace.Reset(graph.NumberOfVertices());
+    backward_workspace.Reach(to_index, 0.0f, -1);
+    workspace.heap.push_back(make_pair(from_index, 0.0f));
+    backward_workspace.heap.push_back(make_pair(to_index, 0.0f));
+
+    // shortest path seen so far through the meeting vertex
+    float best = (from_index == to_index)
+                     ? 0.0f
+                     : numeric_limits<float>::infinity();
+    TVertexID meeting = from_index;
+
+    while (!workspace.heap.empty() && !backward_workspace.heap.empty()) {
+        // every path not seen yet is at least as long as both tops together
+        if (workspace.heap.front().second +
+                backward_workspace.heap.front().second >=
+            best) {
+            break;
+        }
+
+        // grow the smaller frontier
+        const int32_t s = (workspace.heap.size() <=
+                           backward_workspace.heap.size())
+                              ? 0
+                              : 1;
+        CShortestPathWorkspace& W = *side[s];
+        const CShortestPathWorkspace& other = *side[1 - s];
+
+        pop_heap(W.heap.begin(), W.heap.end(), comparator);
+        const TVertexID u_index = W.heap.back().first;
+        W.heap.pop_back();
+
+        if (W.Settled(u_index)) {
+            continue;
+        }
+        W.Settle(u_index);
+        ExpandedVertices++;
+        const float u_dist = W.Dist(u_index);
+
+        for (uint32_t i = adjacency.Begin(u_index); i != adjacency.End(u_index);
+             i++) {
+            TVertexID v_inx = adjacency.Neighbour(i);
+
+            if (graph.GetVertex(v_inx).Color == source_color) {
+                float alt = u_dist + adjacency.Weight(i);
+
+                if ((alt < W.Dist(v_inx)) && !W.Settled(v_inx)) {
+                    W.Reach(v_inx, alt, u_index);
+                    W.heap.push_back(make_pair(v_inx, alt));
+                    push_heap(W.heap.begin(), W.heap.end(), comparator);
+                }
+
+                // the two searches touch at v
+                if (other.Reached(v_inx) &&
+                    (W.Dist(v_inx) + other.Dist(v_inx) < best)) {
+                    best = W.Dist(v_inx) + other.Dist(v_inx);
+                    meeting = v_inx;
+                }
+            }
+        }
+    }
+
+    if (best < numeric_limits<float>::infinity()) {
+        TargetReached = true;
+        TotalDistance = best;
+
+        // source to meeting vertex, then on towards the target
+        workspace.TracePath(meeting, ShortestPath);
+        for (TVertexID v = backward_workspace.Previous(meeting); v >= 0;
+             v = backward_workspace.Previous(v)) {
+            ShortestPath.push_back(v);
+        }
+    }
+
+    return (FinishQuery());
+}
+
+bool CShortestPath::AStarShortestPath(const TVertexID from_index,
+                                      const TVertexID to_index,
+                                      const TDistanceHeuristic& heuristic) {
+    if (!StartQuery(from_index, to_index)) {
+        return (false);
+    }
+
+    const EVertextColor source_color = graph.GetVertex(from_index).Color;
+    vector<TMinHeapPair>& Q = workspace.heap;
+    CMinHeapPairComparator comparator;
+
+    // ordered by distance so far plus the estimate to the target
+    Q.push_back(make_pair(from_index, heuristic(from_index, to_index)));
+
+    while (!Q.empty() && !TargetReached) {
+        pop_heap(Q.begin(), Q.end(), comparator);
+        const TMinHeapPair top = Q.back();
+        Q.pop_back();
+
+        const TVertexID u_index = top.first;
+        const float u_dist = workspace.Dist(u_index);
+
+        // stale entry, the vertex was queued again with a shorter distance
+        if (top.second > u_dist + heuristic(u_index, to_index)) {
+            continue;
+        }
+        ExpandedVertices++;
+
+        if (u_index == to_index) {
+            TargetReached = true;
+            TotalDistance = u_dist;
+            workspace.TracePath(u_index, ShortestPath);
+        } else {
+            for (uint32_t i = adjacency.Begin(u_index);
+                 i != adjacency.End(u_index); i++) {
+                TVertexID v_inx = adjacency.Neighbour(i);
+
+                if (graph.GetVertex(v_inx).Color == source_color) {
+                    float alt = u_dist + adjacency.Weight(i);
+
+                    // no settled check, a vertex expanded too early is
+                    // simply expanded again
+                    if (alt < workspace.Dist(v_inx)) {
+                        workspace.Reach(v_inx, alt, u_index);
+                        Q.push_back(
+                            make_pair(v_inx, alt + heuristic(v_inx, to_index)));
+                        push_heap(Q.begin(), Q.end(), comparator);
+                    }
+                }
+            }
+        }
+    }
+
+    return (FinishQuery());
+}
+
+TDistanceHeuristic EuclideanHeuristic(const vector<pair<float, float>>& coords,
+                                      const float scale) {
+    return [coords, scale](const TVertexID v, const TVertexID target) {
+        const float dx = coords[v].first - coords[target].first;
+        const float dy = coords[v].second - coords[target].second;
+        return (scale * sqrt(dx * dx + dy * dy));
+    };
+}
+
+// all weights are the same, so vertices come out of a plain queue in the
+// order of their distance and every vertex is queued once
+void CShortestPath::UnitWeightSearch(const TVertexID source,
+                                     const TVertexID target) {
+    const EVertextColor source_color = graph.GetVertex(source).Color;
+    vector<TVertexID>& Q = workspace.fifo;
+
+    Q.push_back(source);
+    for (size_t head = 0; (head < Q.size()) && !TargetReached; head++) {
+        const TVertexID u_index = Q[head];
+        const float u_dist = workspace.Dist(u_index);
+        ExpandedVertices++;
+
+        if (u_index == target) {
+            TargetReached = true;
+            TotalDistance = u_dist;
+            workspace.TracePath(u_index, ShortestPath);
+        } else {
+            for (uint32_t i = adjacency.Begin(u_index);
+                 i != adjacency.End(u_index); i++) {
+                TVertexID v_inx = adjacency.Neighbour(i);
+
+                if ((graph.GetVertex(v_inx).Color == source_color) &&
+                    !workspace.Reached(v_inx)) {
+                    workspace.Reach(v_inx, u_dist + unit_weight, u_index);
+                    Q.push_back(v_inx);
                 }
+            }
+        }
+    }
+}
+
+// Dial's algorithm: bucket d holds the vertices at distance d. with weights
+// up to max_bucket_weight only that many buckets are ever in use, so they
+// are reused round robin. zero weights land in the bucket being emptied,
+// which makes this a 0-1 BFS when the weights are 0 and 1
+void CShortestPath::BucketSearch(const TVertexID source,
+                                 const TVertexID target) {
+    const EVertextColor source_color = graph.GetVertex(source).Color;
+    const uint32_t bucket_count = max_bucket_weight + 1;
+    vector<vector<TVertexID>>& buckets = workspace.buckets;
+
+    if (buckets.size() < bucket_count) {
+        buckets.resize(bucket_count);
+    }
+
+    buckets[0].push_back(source);
+    size_t pending = 1;
+
+    for (uint32_t d = 0; (pending > 0) && !TargetReached; d++) {
+        vector<TVertexID>& bucket = buckets[d % bucket_count];
+
+        while (!bucket.empty() && !TargetReached) {
+            const TVertexID u_index = bucket.back();
+            bucket.pop_back();
+            pending--;
+
+            // stale entry, the vertex was queued again with a shorter
+            // distance
+            if (workspace.Settled(u_index) ||
+                (workspace.Dist(u_index) != float(d))) {
+                continue;
+            }
+            workspace.Settle(u_index);
+            ExpandedVertices++;
+
+            if (u_index == target) {
+                TargetReached = true;
+                TotalDistance = float(d);
+                workspace.TracePath(u_index, ShortestPath);
             } else {
-                for (const TEdgeID v : graph.GetVertex(u_index).EdgeList()) {
-                    TVertexID v_inx = graph.GetEdge(v).To().ID();
-                    if (v_inx == u_index) v_inx = graph.GetEdge(v).From().ID();
-
-                    // if next vertex has same color with the source
-                    // then we need to process its edges otherwise just ignore
-                    if (graph.GetVertex(v_inx).Color ==
-                        graph.GetVertex(from_index).Color) {
-                        // accumulate shortest dist from source
-                        float alt = u->dist + graph.GetEdge(v).Value();
-
-                        if ((alt < dijkstra_data[v_inx].dist) &&
-                            !dijkstra_data[v_inx].visited) {
-                            // keep the shortest dist from source to v
-                            dijkstra_data[v_inx].dist = alt;
-                            dijkstra_data[v_inx].previous = u_index;
-
-                            // Add unvisited v into the Q to be processed
-                            Q.push(make_pair(v_inx, dijkstra_data[v_inx].dist));
+                for (uint32_t i = adjacency.Begin(u_index);
+                     i != adjacency.End(u_index); i++) {
+                    TVertexID v_inx = adjacency.Neighbour(i);
+
+                    if (graph.GetVertex(v_inx).Color == source_color) {
+                        const uint32_t alt = d + uint32_t(adjacency.Weight(i));
+
+                        if ((float(alt) < workspace.Dist(v_inx)) &&
+                            !workspace.Settled(v_inx)) {
+                            workspace.Reach(v_inx, float(alt), u_index);
+                            buckets[alt % bucket_count].push_back(v_inx);
+                            pending++;
                         }
                     }
-                }  // end of for(TEdgeList::const_iterator..
+                }
             }
-        }  // end of while(!Q.empty() && !reached_target..
+        }
     }
+}
 
-    return (TargetReached);
+// Dijkstra on a radix heap, keyed by the bits of the distance
+void CShortestPath::RadixHeapSearch(const TVertexID source,
+                                    const TVertexID target) {
+    const EVertextColor source_color = graph.GetVertex(source).Color;
+    CRadixHeap<TVertexID>& Q = workspace.radix_heap;
+
+    Q.Push(FloatKey(0.0f), source);
+    while (!Q.Empty() && !TargetReached) {
+        const TVertexID u_index = Q.Pop().second;
+
+        // the first pop of a vertex has its shortest distance
+        if (workspace.Settled(u_index)) {
+            continue;
+        }
+        workspace.Settle(u_index);
+        ExpandedVertices++;
+        const float u_dist = workspace.Dist(u_index);
+
+        if (u_index == target) {
+            TargetReached = true;
+            TotalDistance = u_dist;
+            workspace.TracePath(u_index, ShortestPath);
+        } else {
+            for (uint32_t i = adjacency.Begin(u_index);
+                 i != adjacency.End(u_index); i++) {
+                TVertexID v_inx = adjacency.Neighbour(i);
+
+                if (graph.GetVertex(v_inx).Color == source_color) {
+                    float alt = u_dist + adjacency.Weight(i);
+
+                    if ((alt < workspace.Dist(v_inx)) &&
+                        !workspace.Settled(v_inx)) {
+                        workspace.Reach(v_inx, alt, u_index);
+                        Q.Push(FloatKey(alt), v_inx);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Dijkstra's_algorithm based on Pseudo code at wiki-pedia:
+// http://en.wikipedia.org/wiki/Dijkstra's_algorithm
+//
+void CShortestPath::BinaryHeapSearch(const TVertexID source,
+                                     const TVertexID target) {
+    const EVertextColor source_color = graph.GetVertex(source).Color;
+    vector<TMinHeapPair>& Q = workspace.heap;
+    CMinHeapPairComparator comparator;
+
+    // Start off with just the source node
+    Q.push_back(make_pair(source, 0.0f));
+
+    while (!Q.empty() && !TargetReached) {
+        // pop the min distance element
+        pop_heap(Q.begin(), Q.end(), comparator);
+        TVertexID u_index = Q.back().first;
+        Q.pop_back();
+
+        // the vertex may be in the heap more than once, the first pop
+        // has the shortest distance
+        if (workspace.Settled(u_index)) {
+            continue;
+        }
+
+        // mark this node as visited
+        workspace.Settle(u_index);
+        ExpandedVertices++;
+        const float u_dist = workspace.Dist(u_index);
+
+        // check whether we reached the target
+        if (u_index == target) {
+            // Now we can read the shortest path from source to target by
+            // reverse iteration
+            TargetReached = true;
+            TotalDistance = u_dist;
+            workspace.TracePath(u_index, ShortestPath);
+        } else {
+            for (uint32_t i = adjacency.Begin(u_index);
+                 i != adjacency.End(u_index); i++) {
+                TVertexID v_inx = adjacency.Neighbour(i);
+
+                // if next vertex has same color with the source
+                // then we need to process its edges otherwise just ignore
+                if (graph.GetVertex(v_inx).Color == source_color) {
+                    // accumulate shortest dist from source
+                    float alt = u_dist + adjacency.Weight(i);
+
+                    if ((alt < workspace.Dist(v_inx)) &&
+                        !workspace.Settled(v_inx)) {
+                        // keep the shortest dist from source to v
+                        workspace.Reach(v_inx, alt, u_index);
+
+                        // Add unvisited v into the Q to be processed
+                        Q.push_back(make_pair(v_inx, alt));
+                        push_heap(Q.begin(), Q.end(), comparator);
+                    }
+                }
+            }  // end of for(adjacency of u..
+        }
+    }  // end of while(!Q.empty() && !reached_target..
 }
 
-class CMinEdgePointerComparator {
+// edge of a spanning tree search, copied out of the graph so that the
+// searches can sort and filter a flat array
+class CTreeEdge {
    public:
-    // compares distances
-    bool operator()(const CEdge* x, const CEdge* y) {
-        return (x->Value() > y->Value());
-    }
+    float value;
+    TVertexID from;
+    TVertexID to;
+    TEdgeID id;
 };
 
+typedef vector<CTreeEdge> TTreeEdges;
+
+static TTreeEdges LiveTreeEdges(const CGraph& g) {
+    TTreeEdges edges;
+
+    edges.reserve(g.NumberOfEdges());
+    for (const CEdge& e : g.EdgeList()) {
+        if (!e.Removed()) {
+            edges.push_back({e.Value(), e.From().ID(), e.To().ID(), e.ID()});
+        }
+    }
+    return (edges);
+}
+
+// below this many edges Filter-Kruskal just sorts
+static const ptrdiff_t KruskalSortThreshold = 1024;
+
+// Filter-Kruskal: split the edges at a pivot weight, build the tree of the
+// light part first, and drop the heavy edges which that tree has already
+// connected before looking at them. on most graphs only a small part of the
+// heavy edges survives, so most edges are never sorted
+static void FilterKruskal(TTreeEdges::iterator first, TTreeEdges::iterator last,
+                          CUnionFind& forest, TMinimalSpanningTree& tree,
+                          float& tree_distance) {
+    TTreeEdges::iterator middle = first;
+
+    if (last - first > KruskalSortThreshold) {
+        // median of three as pivot
+        float a = first->value;
+        float b = (first + (last - first) / 2)->value;
+        float c = (last - 1)->value;
+        const float pivot = max(min(a, b), min(max(a, b), c));
+
+        middle = partition(first, last, [pivot](const CTreeEdge& e) {
+            return (e.value < pivot);
+        });
+
+        // with many edges of the pivot weight the light part may be empty
+        if (middle == first) {
+            middle = partition(first, last, [pivot](const CTreeEdge& e) {
+                return (e.value <= pivot);
+            });
+        }
+    }
+
+    // all edges on one side, nothing to split any more
+    if ((middle == first) || (middle == last)) {
+        sort(first, last, [](const CTreeEdge& x, const CTreeEdge& y) {
+            return (x.value < y.value);
+        });
+
+        for (TTreeEdges::iterator e = first; e != last; e++) {
+            if (forest.Union(e->from, e->to)) {
+                tree.push_back(e->id);
+                tree_distance += e->value;
+            }
+        }
+        return;
+    }
+
+    FilterKruskal(first, middle, forest, tree, tree_distance);
+
+    TTreeEdges::iterator heavy_end =
+        remove_if(middle, last, [&forest](const CTreeEdge& e) {
+            return (forest.Connected(e.from, e.to));
+        });
+    FilterKruskal(middle, heavy_end, forest, tree, tree_distance);
+}
+
 // Kruskal minimal spanning tree algorithm based on Pseudo code at wiki-pedia:
 // http://en.wikipedia.org/wiki/Kruskal's_algorithm
 //
@@ -117,39 +584,122 @@ void CShortestPath::KruskalMinimalSpanningTree() {
     MinimalSpanningTree.clear();
     MinimalSpanningTreeDistance = 0.0f;
 
-    priority_queue<const CEdge*, vector<const CEdge*>,
-                   CMinEdgePointerComparator>
-        Q;
-    vector<TVertexID> visited_vertices;
+    TTreeEdges edges = LiveTreeEdges(graph);
+    CUnionFind forest(graph.NumberOfVertices());
+
+    FilterKruskal(edges.begin(), edges.end(), forest, MinimalSpanningTree,
+                  MinimalSpanningTreeDistance);
+}
+
+// float bits turned into an unsigned integer of the same order, negative
+// values included
+static uint32_t OrderedFloatKey(const float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return ((bits & 0x80000000u) ? ~bits : (bits | 0x80000000u));
+}
 
-    // add all edges to priority queue
-    for (auto& e : graph.EdgeList()) {
-        Q.push(&e);
+static void AtomicMin(atomic<uint64_t>& target, const uint64_t value) {
+    uint64_t current = target.load(memory_order_relaxed);
+    while ((value < current) &&
+           !target.compare_exchange_weak(current, value,
+                                         memory_order_relaxed)) {
     }
+}
+
+// edges handed to one pool task per round
+static const uint32_t BoruvkaEdgesPerTask = 1 << 16;
+
+// Boruvka's algorithm: in every round each component picks its lightest
+// outgoing edge, and all of those are added at once. ties are broken by the
+// edge position, which keeps the picked edges free of cycles. the rounds at
+// least halve the number of components, and the edge scans run on the pool
+void CShortestPath::BoruvkaMinimalSpanningTree(CThreadPool& pool) {
+    MinimalSpanningTree.clear();
+    MinimalSpanningTreeDistance = 0.0f;
 
-    // we should trace vertices for loops
-    // initialize as non of vertices visited
-    for (auto& v : graph.VerticesList()) {
-        visited_vertices.push_back(v.ID());
+    const uint32_t vertex_count = graph.NumberOfVertices();
+    TTreeEdges edges = LiveTreeEdges(graph);
+    CUnionFind forest(vertex_count);
+
+    // component of each vertex, refreshed after every round
+    vector<TVertexID> component(vertex_count);
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        component[v] = v;
     }
 
-    while (!Q.empty()) {
-        const CEdge* e = Q.top();
-        Q.pop();
+    // (weight key, edge position) of the lightest edge leaving a component
+    unique_ptr<atomic<uint64_t>[]> lightest(
+        new atomic<uint64_t>[vertex_count]);
+    const uint64_t none = numeric_limits<uint64_t>::max();
+
+    vector<TTreeEdges> survivors;
+    bool merged = true;
+
+    while (merged && !edges.empty()) {
+        const uint32_t task_count =
+            (edges.size() + BoruvkaEdgesPerTask - 1) / BoruvkaEdgesPerTask;
+
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            lightest[v].store(none, memory_order_relaxed);
+        }
+
+        pool.Run(task_count, [&](const uint32_t, const uint32_t task) {
+            const size_t end =
+                min(edges.size(), size_t(task + 1) * BoruvkaEdgesPerTask);
 
-        TVertexID parent_from = visited_vertices[e->From().ID()];
-        TVertexID parent_to = visited_vertices[e->To().ID()];
+            for (size_t i = size_t(task) * BoruvkaEdgesPerTask; i < end; i++) {
+                const TVertexID cu = component[edges[i].from];
+                const TVertexID cv = component[edges[i].to];
 
-        if (parent_from != parent_to) {
-            MinimalSpanningTree.push_back(e);
-            MinimalSpanningTreeDistance += e->Value();
+                if (cu != cv) {
+                    const uint64_t key =
+                        (uint64_t(OrderedFloatKey(edges[i].value)) << 32) | i;
+                    AtomicMin(lightest[cu], key);
+                    AtomicMin(lightest[cv], key);
+                }
+            }
+        });
+
+        // two components may pick the same edge, Union() adds it once
+        merged = false;
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            const uint64_t key = lightest[v].load(memory_order_relaxed);
+
+            if ((component[v] == TVertexID(v)) && (key != none)) {
+                const CTreeEdge& e = edges[uint32_t(key)];
+
+                if (forest.Union(e.from, e.to)) {
+                    MinimalSpanningTree.push_back(e.id);
+                    MinimalSpanningTreeDistance += e.value;
+                    merged = true;
+                }
+            }
+        }
+
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            component[v] = forest.Find(v);
+        }
+
+        // keep only the edges between different components, each task
+        // filters its own range
+        survivors.resize(task_count);
+        pool.Run(task_count, [&](const uint32_t, const uint32_t task) {
+            const size_t end =
+                min(edges.size(), size_t(task + 1) * BoruvkaEdgesPerTask);
 
-            // union(from, to)
-            for (auto& visited_vertex : visited_vertices) {
-                if (visited_vertex == parent_to) {
-                    visited_vertex = parent_from;
+            survivors[task].clear();
+            for (size_t i = size_t(task) * BoruvkaEdgesPerTask; i < end; i++) {
+                if (component[edges[i].from] != component[edges[i].to]) {
+                    survivors[task].push_back(edges[i]);
                 }
             }
+        });
+
+        edges.clear();
+        for (uint32_t task = 0; task < task_count; task++) {
+            edges.insert(edges.end(), survivors[task].begin(),
+                         survivors[task].end());
         }
     }
 }
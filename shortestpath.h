@@ -1,40 +1,221 @@
 #ifndef SHORTESTPATH_H
 #define SHORTESTPATH_H
 
+#include <algorithm>
 #include <cstdint>  // for platform independent types
-#include <list>
+#include <functional>
+#include <limits>
+#include <vector>
 using namespace std;
 
 #include "graph.h"
+#include "graphcsr.h"
+#include "radixheap.h"
+#include "telemetry.h"
+#include "threadpool.h"
 
-typedef list<const CVertex*> TShortestPath;
-typedef list<const CEdge*> TMinimalSpanningTree;
+// vertex ids from source to target
+typedef vector<TVertexID> TShortestPath;
+// edge ids of the tree
+typedef vector<TEdgeID> TMinimalSpanningTree;
+
+// how a shortest path query orders the vertices it settles
+enum class EShortestPathKernel : uint8_t {
+    spkAUTO,          // picked from the weights of the graph
+    spkUNIT,          // breadth first, all edges have the same weight
+    spkBUCKET,        // Dial's buckets, small non-negative integer weights
+    spkRADIX_HEAP,    // any non-negative weights
+    spkBINARY_HEAP    // anything else
+};
+
+// lower bound of the distance from v to target, used by A*. it must never
+// overestimate, otherwise A* may return a longer path
+typedef function<float(const TVertexID v, const TVertexID target)>
+    TDistanceHeuristic;
+
+// straight line distance between vertex coordinates, for graphs whose edges
+// are at least scale times as heavy as they are long
+TDistanceHeuristic EuclideanHeuristic(const vector<pair<float, float>>& coords,
+                                      const float scale = 1.0f);
+
+// Per vertex state of a shortest path search, kept between queries.
+//
+// Entries are valid only if their stamp equals the current epoch, so a new
+// query starts with one increment instead of clearing every vertex, and it
+// only touches the vertices it reaches. The heap keeps its capacity too, so
+// after the first few queries a search does not allocate at all.
+class CShortestPathWorkspace {
+   private:
+    vector<uint32_t> reached_stamp;
+    vector<uint32_t> settled_stamp;
+    vector<float> dist;
+    vector<TVertexID> previous;
+    uint32_t epoch;
+
+   public:
+    // (vertex, distance) pairs, ordered by the search that uses them
+    vector<pair<TVertexID, float>> heap;
+
+    // queues of the other kernels, emptied by Reset() as well
+    vector<TVertexID> fifo;
+    vector<vector<TVertexID>> buckets;
+    CRadixHeap<TVertexID> radix_heap;
+
+    CShortestPathWorkspace() : epoch(0) {}
+
+    // starts a new query over vertex_count vertices
+    void Reset(const uint32_t vertex_count) {
+        if (reached_stamp.size() < vertex_count) {
+            reached_stamp.resize(vertex_count, 0);
+            settled_stamp.resize(vertex_count, 0);
+            dist.resize(vertex_count);
+            previous.resize(vertex_count);
+        }
+
+        // stamps of old queries could match again after a wrap
+        if (++epoch == 0) {
+            fill(reached_stamp.begin(), reached_stamp.end(), 0);
+            fill(settled_stamp.begin(), settled_stamp.end(), 0);
+            epoch = 1;
+        }
+
+        heap.clear();
+        fifo.clear();
+        for (vector<TVertexID>& b : buckets) {
+            b.clear();
+        }
+        radix_heap.Clear();
+    }
+
+    bool Reached(const TVertexID v) const { return reached_stamp[v] == epoch; }
+    bool Settled(const TVertexID v) const { return settled_stamp[v] == epoch; }
+
+    // infinite until the vertex is reached
+    float Dist(const TVertexID v) const {
+        return (Reached(v) ? dist[v] : numeric_limits<float>::infinity());
+    }
+    TVertexID Previous(const TVertexID v) const { return previous[v]; }
+
+    void Reach(const TVertexID v, const float d, const TVertexID prev) {
+        reached_stamp[v] = epoch;
+        dist[v] = d;
+        previous[v] = prev;
+    }
+    void Settle(const TVertexID v) { settled_stamp[v] = epoch; }
+
+    // follows the previous links back from target, and stores the vertices
+    // from source to target in path
+    void TracePath(const TVertexID target, TShortestPath& path) const {
+        path.clear();
+        for (TVertexID v = target; v >= 0; v = previous[v]) {
+            path.push_back(v);
+        }
+        reverse(path.begin(), path.end());
+    }
+};
 
 class CShortestPath {
    private:
     CGraph& graph;
 
+    // flat copy of the graph topology, rebuilt when the graph has changed
+    CGraphCSR adjacency;
+    uint64_t adjacency_version;
+    bool adjacency_built;
+
+    // reused by every query, the backward one by the bidirectional search
+    CShortestPathWorkspace workspace;
+    CShortestPathWorkspace backward_workspace;
+
+    // kernel asked for and the one in use, the latter is chosen again
+    // whenever the adjacency is rebuilt
+    EShortestPathKernel kernel_setting;
+    EShortestPathKernel kernel;
+
+    // weight of every edge for spkUNIT, the largest weight for spkBUCKET
+    float unit_weight;
+    uint32_t max_bucket_weight;
+
+    // totals of all queries since the last ResetCounters()
+    CShortestPathCounters counters;
+
+    void RefreshAdjacency(void);
+    void ChooseKernel(void);
+
+    // clears the results and prepares the workspace, false if the source
+    // and target colors differ so that there can be no path
+    bool StartQuery(const TVertexID source, const TVertexID target);
+
+    // adds the last query to the counters, returns TargetReached
+    bool FinishQuery(void);
+
+    // each of them searches from source to target over vertices of the
+    // source color, and sets TargetReached, TotalDistance and ShortestPath
+    void UnitWeightSearch(const TVertexID source, const TVertexID target);
+    void BucketSearch(const TVertexID source, const TVertexID target);
+    void RadixHeapSearch(const TVertexID source, const TVertexID target);
+    void BinaryHeapSearch(const TVertexID source, const TVertexID target);
+
    public:
+    // vertex ids of the last path found, contiguous and reused between
+    // queries
     TShortestPath ShortestPath;
     float TotalDistance;
     bool TargetReached;
 
+    // vertices taken off the queue by the last query, to compare searches
+    uint64_t ExpandedVertices;
+
     float MinimalSpanningTreeDistance;
     TMinimalSpanningTree MinimalSpanningTree;
 
     // constructor
-    CShortestPath(CGraph& g) : graph(g) {
+    CShortestPath(CGraph& g)
+        : graph(g),
+          adjacency_version(0),
+          adjacency_built(false),
+          kernel_setting(EShortestPathKernel::spkAUTO),
+          kernel(EShortestPathKernel::spkBINARY_HEAP),
+          unit_weight(0.0f),
+          max_bucket_weight(0) {
         ShortestPath.clear();
         TotalDistance = 0.0f;
         TargetReached = false;
+        ExpandedVertices = 0;
 
         MinimalSpanningTreeDistance = 0.0f;
         MinimalSpanningTree.clear();
     }
 
+    // integer weights up to this go to the bucket kernel
+    static const uint32_t MaxBucketWeight = 1024;
+
+    // spkAUTO picks the fastest kernel that is exact for the weights. a
+    // kernel the weights do not allow falls back to the binary heap
+    void SetKernel(const EShortestPathKernel k);
+    EShortestPathKernel Kernel(void);
+
+    const CShortestPathCounters& Counters(void) const { return counters; }
+    void ResetCounters(void) { counters = CShortestPathCounters(); }
+
     bool DijkstraShortestPath(const TVertexID from_index,
                               const TVertexID to_index);
+
+    // Dijkstra from both ends at once, stops when the two frontiers can not
+    // give a shorter path than the best one found where they touched
+    bool BidirectionalShortestPath(const TVertexID from_index,
+                                   const TVertexID to_index);
+
+    // Dijkstra guided by a heuristic towards the target. vertices may be
+    // expanded again, so the heuristic only has to be admissible
+    bool AStarShortestPath(const TVertexID from_index, const TVertexID to_index,
+                           const TDistanceHeuristic& heuristic);
+    // both build a minimal spanning forest if the graph is not connected
     void KruskalMinimalSpanningTree(void);
+
+    // Boruvka's algorithm with the edge scans spread over the pool, for
+    // graphs with millions of edges
+    void BoruvkaMinimalSpanningTree(CThreadPool& pool);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "solver.h"
+
+#include <cassert>
+#include <limits>
+
+#include "inferior.h"
+
+// xored into the keys of positions with red to move
+static const uint64_t RED_TO_MOVE_KEY = 0x9E3779B97F4A7C15ull;
+
+// deadline is checked once per this many nodes
+static const int64_t DEADLINE_INTERVAL = 1024;
+
+static uint32_t AddNumbers(const uint32_t x, const uint32_t y) {
+    return (static_cast<uint32_t>(
+        min<uint64_t>(static_cast<uint64_t>(x) + y,
+                      CProofNumberSolver::Infinity)));
+}
+
+CProofNumberSolver::CProofNumberSolver(const uint64_t entry_count)
+    : deadline(nullptr), node_limit(0), aborted(false) {
+    uint64_t buckets = 1;
+    while (buckets * 2 * BucketSize <= entry_count) {
+        buckets *= 2;
+    }
+
+    bucket_mask = buckets - 1;
+    entries.reset(new CEntry[buckets * BucketSize]);
+    Clear();
+}
+
+void CProofNumberSolver::Clear() {
+    for (uint64_t i = 0; i < (bucket_mask + 1) * BucketSize; i++) {
+        entries[i] = CEntry{0, 0, 0, 0};
+    }
+}
+
+uint64_t CProofNumberSolver::Key(const uint64_t canonical_hash,
+                                 const EVertextColor c) {
+    return (canonical_hash ^
+            (c == EVertextColor::vtRED ? RED_TO_MOVE_KEY : 0));
+}
+
+bool CProofNumberSolver::Probe(const uint64_t key, uint32_t& pn,
+                               uint32_t& dn) const {
+    const CEntry* bucket = &entries[(key & bucket_mask) * BucketSize];
+
+    // empty entries have no work, so key 0 is never found by mistake
+    for (uint32_t i = 0; i < BucketSize; i++) {
+        if ((bucket[i].key == key) && (bucket[i].work != 0)) {
+            pn = bucket[i].pn;
+            dn = bucket[i].dn;
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+void CProofNumberSolver::Store(const uint64_t key, const uint32_t pn,
+                               const uint32_t dn, const int64_t work) {
+    CEntry* bucket = &entries[(key & bucket_mask) * BucketSize];
+    CEntry* target = &bucket[0];
+
+    for (uint32_t i = 0; i < BucketSize; i++) {
+        if ((bucket[i].key == key) && (bucket[i].work != 0)) {
+            target = &bucket[i];
+            break;
+        }
+        if (bucket[i].work < target->work) {
+            target = &bucket[i];
+        }
+    }
+
+    // a position searched again keeps the work of both searches
+    int64_t total = (target->key == key) ? target->work + work : work;
+    *target = CEntry{key, pn, dn, max<int64_t>(total, 1)};
+}
+
+void CProofNumberSolver::MID(CBitBoard& position, const EVertextColor to_move,
+                             const uint32_t depth, const uint32_t pn_threshold,
+                             const uint32_t dn_threshold, uint32_t& pn,
+                             uint32_t& dn) {
+    const EVertextColor opponent = OpponentColor(to_move);
+    const uint64_t key = Key(position.CanonicalHash(), to_move);
+    const int64_t start_nodes = counters.nodes;
+
+    counters.nodes++;
+    if ((counters.nodes >= node_limit) ||
+        (((counters.nodes % DEADLINE_INTERVAL) == 0) && deadline->Expired())) {
+        aborted = true;
+    }
+
+    // the last move may have won, or the captured cells may decide the game
+    // before the board is full
+    CBitBoard filled = position;
+    (void)FillCapturedCells(filled);
+
+    if (filled.IsWinner(opponent)) {
+        pn = Infinity;
+        dn = 0;
+        Store(key, pn, dn, counters.nodes - start_nodes);
+        return;
+    }
+    if (filled.IsWinner(to_move)) {
+        pn = 0;
+        dn = Infinity;
+        Store(key, pn, dn, counters.nodes - start_nodes);
+        return;
+    }
+
+    vector<CChild>& children = depth_children[depth];
+    children.clear();
+
+    const int32_t cells = position.Width() * position.Width();
+    for (TVertexID id = 0; id < cells; id++) {
+        if (filled.Get(id) != EVertextColor::vtWHITE) {
+            continue;
+        }
+
+        // a move which connects right away needs no search
+        filled.Set(id, to_move);
+        bool wins = filled.IsWinner(to_move);
+        filled.Set(id, EVertextColor::vtWHITE);
+
+        if (wins) {
+            pn = 0;
+            dn = Infinity;
+            Store(key, pn, dn, counters.nodes - start_nodes);
+            return;
+        }
+
+        CChild child{id, 1, 1};
+        (void)Probe(Key(position.CanonicalHashAfter(id, to_move), opponent),
+                    child.pn, child.dn);
+        children.push_back(child);
+    }
+
+    for (;;) {
+        // proof number is the smallest disproof number of the children,
+        // disproof number the sum of their proof numbers
+        CChild* best = &children[0];
+        uint32_t second_dn = Infinity;
+
+        pn = Infinity;
+        dn = 0;
+        for (CChild& child : children) {
+            if (child.dn < pn) {
+                second_dn = pn;
+                pn = child.dn;
+                best = &child;
+            } else if (child.dn < second_dn) {
+                second_dn = child.dn;
+            }
+            dn = AddNumbers(dn, child.pn);
+        }
+
+        if ((pn >= pn_threshold) || (dn >= dn_threshold) || aborted) {
+            break;
+        }
+
+        // the best child may use what the other children leave of the
+        // disproof threshold, and has to stay below the second best's
+        // disproof number to remain the best
+        uint32_t child_pn_threshold =
+            AddNumbers(dn_threshold - dn, best->pn);
+        uint32_t child_dn_threshold =
+            min(pn_threshold, AddNumbers(second_dn, 1));
+
+        position.Set(best->move, to_move);
+        MID(position, opponent, depth + 1, child_pn_threshold,
+            child_dn_threshold, best->pn, best->dn);
+        position.Set(best->move, EVertextColor::vtWHITE);
+    }
+
+    Store(key, pn, dn, counters.nodes - start_nodes);
+}
+
+ESolverResult CProofNumberSolver::Solve(const CBitBoard& position,
+                                        const EVertextColor to_move,
+                                        const int64_t node_limit,
+                                        const CSearchDeadline& deadline,
+                                        TVertexID& winning_move) {
+    steady_clock::time_point start = steady_clock::now();
+
+    this->deadline = &deadline;
+    this->node_limit =
+        (node_limit < numeric_limits<int64_t>::max() - counters.nodes)
+            ? counters.nodes + node_limit
+            : numeric_limits<int64_t>::max();
+    aborted = false;
+
+    // one list per stone which can still be placed, sized before the search
+    // as the lists of the outer nodes are in use
+    const int32_t cells = position.Width() * position.Width();
+    if (depth_children.size() <= static_cast<size_t>(cells)) {
+        depth_children.resize(cells + 1);
+    }
+
+    CBitBoard root = position;
+    uint32_t pn;
+    uint32_t dn;
+    MID(root, to_move, 0, Infinity, Infinity, pn, dn);
+
+    ESolverResult result = ESolverResult::srUNKNOWN;
+    if (pn == 0) {
+        result = ESolverResult::srWIN;
+    } else if (dn == 0) {
+        result = ESolverResult::srLOSS;
+    }
+
+    if (result == ESolverResult::srWIN) {
+        CBitBoard filled = position;
+        (void)FillCapturedCells(filled);
+
+        winning_move = -1;
+        if (filled.IsWinner(to_move)) {
+            // the captured cells alone win, every move keeps the win
+            for (TVertexID id = 0; (id < cells) && (winning_move < 0); id++) {
+                if (position.Get(id) == EVertextColor::vtWHITE) {
+                    winning_move = id;
+                }
+            }
+        } else {
+            // a move which connects at once ends the root before all its
+            // children are listed, otherwise the root's own child list has
+            // one lost for the opponent. the table may have lost its entry
+            for (TVertexID id = 0; (id < cells) && (winning_move < 0); id++) {
+                if (filled.Get(id) == EVertextColor::vtWHITE) {
+                    filled.Set(id, to_move);
+                    if (filled.IsWinner(to_move)) {
+                        winning_move = id;
+                    }
+                    filled.Set(id, EVertextColor::vtWHITE);
+                }
+            }
+            for (const CChild& child : depth_children[0]) {
+                if ((winning_move < 0) && (child.dn == 0)) {
+                    winning_move = child.move;
+                }
+            }
+        }
+
+        assert(winning_move >= 0);
+    }
+
+    counters.solves++;
+    if (result != ESolverResult::srUNKNOWN) {
+        counters.proven++;
+    }
+    counters.solve_time +=
+        duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    return (result);
+}
@@ -0,0 +1,99 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <cstdint>  // for platform independent types
+#include <memory>
+#include <vector>
+using namespace std;
+
+#include "batchplayout.h"  // for TVectorIDList
+#include "bitboard.h"
+#include "deadline.h"
+#include "telemetry.h"
+
+// outcome of a solve, for the player to move
+enum class ESolverResult : uint8_t { srWIN, srLOSS, srUNKNOWN };
+
+// Exact endgame search by depth-first proof-number search (df-pn).
+//
+// Every position has a proof number, the least number of positions still
+// to solve to prove a win for the player to move, and a disproof number,
+// the same for a loss. In negamax form the proof number of a position is
+// the smallest disproof number of its children and its disproof number the
+// sum of their proof numbers. The search always works on the most proving
+// child, and only goes back up once the numbers of the position pass the
+// thresholds the parent gave it, so it needs memory just for its path and
+// for the table.
+//
+// The numbers are kept in a fixed size table keyed by the canonical hash of
+// the position and the player to move. Positions which took the least work
+// to solve make way for new ones, and the table lives on between solves,
+// so a proof found for one move makes the proofs of the next moves cheap.
+//
+// Captured cells are filled in at every position, which often decides it
+// before the board is full, and dead cells are no moves.
+class CProofNumberSolver {
+   public:
+    static const uint32_t Infinity = 0x3FFFFFFF;
+    static const uint32_t BucketSize = 2;
+
+   private:
+    class CEntry {
+       public:
+        uint64_t key;
+        uint32_t pn;
+        uint32_t dn;
+        int64_t work;  // nodes spent on the position
+    };
+
+    // a move and the numbers of the position after it
+    class CChild {
+       public:
+        TVertexID move;
+        uint32_t pn;
+        uint32_t dn;
+    };
+
+    unique_ptr<CEntry[]> entries;
+    uint64_t bucket_mask;
+
+    // children of the node at each search depth, reused between nodes. a
+    // node keeps the numbers of its children itself, as their entries may
+    // be replaced while it searches them
+    vector<vector<CChild>> depth_children;
+
+    const CSearchDeadline* deadline;
+    int64_t node_limit;
+    bool aborted;
+    CSolverCounters counters;
+
+    static uint64_t Key(const uint64_t canonical_hash, const EVertextColor c);
+
+    bool Probe(const uint64_t key, uint32_t& pn, uint32_t& dn) const;
+    void Store(const uint64_t key, const uint32_t pn, const uint32_t dn,
+               const int64_t work);
+
+    // searches position until its numbers reach a threshold, and returns
+    // them
+    void MID(CBitBoard& position, const EVertextColor to_move,
+             const uint32_t depth, const uint32_t pn_threshold,
+             const uint32_t dn_threshold, uint32_t& pn, uint32_t& dn);
+
+   public:
+    // entry_count is rounded down to a power of two, at least one bucket
+    CProofNumberSolver(const uint64_t entry_count = 1 << 20);
+
+    void Clear(void);
+
+    // solves position for to_move within node_limit nodes and the deadline.
+    // winning_move is a move which keeps the win if the result is srWIN
+    ESolverResult Solve(const CBitBoard& position,
+                        const EVertextColor to_move, const int64_t node_limit,
+                        const CSearchDeadline& deadline,
+                        TVertexID& winning_move);
+
+    const CSolverCounters& Counters(void) const { return counters; }
+    void ResetCounters(void) { counters = CSolverCounters(); }
+};
+
+#endif
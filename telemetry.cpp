@@ -0,0 +1,75 @@
+#include "telemetry.h"
+
+#include <iomanip>
+#include <sstream>
+
+static double Rate(const int64_t wins, const int64_t playouts) {
+    return (playouts > 0 ? static_cast<double>(wins) / playouts : 0.0);
+}
+
+static double Milliseconds(const int64_t ns) { return (ns / 1e6); }
+
+string CSearchReport::Text() const {
+    ostringstream out;
+
+    out << fixed << setprecision(3);
+    out << "Search: " << playouts.playouts << " playouts in " << seconds
+        << " s, " << setprecision(0)
+        << (seconds > 0.0 ? playouts.playouts / seconds : 0.0)
+        << " playouts/s\n";
+    out << setprecision(1);
+
+    if (playouts.reset_time + playouts.fill_time + playouts.detect_time > 0) {
+        out << "Playout time: reset " << Milliseconds(playouts.reset_time)
+            << " ms, fill " << Milliseconds(playouts.fill_time)
+            << " ms, win detection " << Milliseconds(playouts.detect_time)
+            << " ms\n";
+    }
+
+    out << "Shortest paths: " << shortest_paths.queries << " queries, "
+        << shortest_paths.expanded_vertices << " vertices expanded\n";
+
+    if (solver.solves > 0) {
+        out << "Solver: " << solver_result << " after " << solver.nodes
+            << " nodes in " << Milliseconds(solver.solve_time) << " ms\n";
+    }
+
+    for (size_t i = 0; (i < candidates.size()) && (i < TextCandidates); i++) {
+        const CCandidateReport& c = candidates[i];
+        out << "  " << setw(4) << c.move << setw(10) << c.playouts
+            << " playouts " << setw(6) << 100.0 * Rate(c.wins, c.playouts)
+            << " % wins\n";
+    }
+
+    return (out.str());
+}
+
+string CSearchReport::Json() const {
+    ostringstream out;
+
+    out << "{\"move_number\":" << move_number << ",\"engine\":\"" << engine
+        << "\",\"move\":\"" << move << "\",\"seconds\":" << seconds
+        << ",\"playouts\":" << playouts.playouts << ",\"playouts_per_second\":"
+        << (seconds > 0.0 ? playouts.playouts / seconds : 0.0)
+        << ",\"placed_stones\":" << playouts.placed_stones
+        << ",\"skipped_stones\":" << playouts.skipped_stones
+        << ",\"reset_ns\":" << playouts.reset_time
+        << ",\"fill_ns\":" << playouts.fill_time
+        << ",\"detect_ns\":" << playouts.detect_time
+        << ",\"shortest_path_queries\":" << shortest_paths.queries
+        << ",\"expanded_vertices\":" << shortest_paths.expanded_vertices
+        << ",\"solver_result\":\"" << solver_result
+        << "\",\"solver_nodes\":" << solver.nodes
+        << ",\"solver_ns\":" << solver.solve_time
+        << ",\"candidates\":[";
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const CCandidateReport& c = candidates[i];
+        out << (i ? "," : "") << "{\"move\":\"" << c.move
+            << "\",\"playouts\":" << c.playouts << ",\"wins\":" << c.wins
+            << "}";
+    }
+    out << "]}";
+
+    return (out.str());
+}
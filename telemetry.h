@@ -0,0 +1,131 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <chrono>
+#include <cstdint>  // for platform independent types
+#include <string>
+#include <vector>
+using namespace std;
+using namespace chrono;
+
+// Work done by one playout engine. Every engine, and so every worker thread,
+// has its own counters, which are summed up when a report asks for them.
+//
+// The phase times are only measured when timing is switched on, since
+// reading the clock around every phase costs more than the reset of a full
+// fill playout itself. Early stop playouts check for a win while they place
+// the stones, so their placement loop counts as win detection.
+class CPlayoutCounters {
+   public:
+    int64_t playouts;
+
+    // stone placements of early stop playouts, skipped ones are those which a
+    // full fill would have placed after the decisive connection
+    int64_t placed_stones;
+    int64_t skipped_stones;
+
+    // nanoseconds spent in each phase of the playouts
+    int64_t reset_time;
+    int64_t fill_time;
+    int64_t detect_time;
+
+    CPlayoutCounters()
+        : playouts(0),
+          placed_stones(0),
+          skipped_stones(0),
+          reset_time(0),
+          fill_time(0),
+          detect_time(0) {}
+
+    CPlayoutCounters& operator+=(const CPlayoutCounters& x) {
+        playouts += x.playouts;
+        placed_stones += x.placed_stones;
+        skipped_stones += x.skipped_stones;
+        reset_time += x.reset_time;
+        fill_time += x.fill_time;
+        detect_time += x.detect_time;
+        return (*this);
+    }
+};
+
+// adds the time since start to counter and restarts the clock, only if the
+// clock is running at all
+class CPhaseClock {
+   private:
+    bool running;
+    steady_clock::time_point start;
+
+   public:
+    CPhaseClock(const bool run)
+        : running(run),
+          start(run ? steady_clock::now() : steady_clock::time_point()) {}
+
+    void Lap(int64_t& counter) {
+        if (running) {
+            steady_clock::time_point now = steady_clock::now();
+            counter += duration_cast<nanoseconds>(now - start).count();
+            start = now;
+        }
+    }
+};
+
+// shortest path queries and the vertices they took off their queues
+class CShortestPathCounters {
+   public:
+    int64_t queries;
+    int64_t expanded_vertices;
+
+    CShortestPathCounters() : queries(0), expanded_vertices(0) {}
+};
+
+// endgame solver runs, the positions they searched and how long they took
+class CSolverCounters {
+   public:
+    int64_t solves;
+    int64_t proven;  // solves which found the result
+    int64_t nodes;
+    int64_t solve_time;  // nanoseconds
+
+    CSolverCounters() : solves(0), proven(0), nodes(0), solve_time(0) {}
+};
+
+// playouts and wins of one candidate move of a report
+class CCandidateReport {
+   public:
+    string move;
+    int64_t playouts;
+    int64_t wins;
+
+    CCandidateReport(const string& m = "", const int64_t p = 0,
+                     const int64_t w = 0)
+        : move(m), playouts(p), wins(w) {}
+};
+
+// What the AI did for one move, printed after the move or logged as one
+// JSON line
+class CSearchReport {
+   public:
+    int32_t move_number;
+    string engine;
+    string move;
+    double seconds;
+    CPlayoutCounters playouts;
+    CShortestPathCounters shortest_paths;
+    CSolverCounters solver;
+
+    // win, loss or unknown if the solver ran on the move
+    string solver_result;
+
+    // sorted by playouts, most searched first
+    vector<CCandidateReport> candidates;
+
+    CSearchReport() : move_number(0), seconds(0.0) {}
+
+    // candidates shown by Text(), Json() has all of them
+    static const size_t TextCandidates = 5;
+
+    string Text(void) const;
+    string Json(void) const;
+};
+
+#endif
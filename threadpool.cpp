@@ -0,0 +1,157 @@
+#include "threadpool.h"
+
+static inline uint64_t PackRange(const uint32_t begin, const uint32_t end) {
+    return ((static_cast<uint64_t>(end) << 32) | begin);
+}
+
+static inline uint32_t RangeBegin(const uint64_t r) {
+    return (static_cast<uint32_t>(r));
+}
+
+static inline uint32_t RangeEnd(const uint64_t r) {
+    return (static_cast<uint32_t>(r >> 32));
+}
+
+CThreadPool::CThreadPool(const uint32_t count)
+    : thread_count(count),
+      job_generation(0),
+      busy_workers(0),
+      stopping(false),
+      job(nullptr) {
+    if (thread_count == 0) {
+        thread_count = max(1u, thread::hardware_concurrency());
+    }
+
+    work_ranges.reset(new CWorkRange[thread_count]);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        work_ranges[i].range = PackRange(0, 0);
+    }
+
+    // worker 0 is the thread which calls Run()
+    for (uint32_t i = 1; i < thread_count; i++) {
+        threads.emplace_back(&CThreadPool::WorkerLoop, this, i);
+    }
+}
+
+CThreadPool::~CThreadPool() {
+    {
+        lock_guard<mutex> lock(job_mutex);
+        stopping = true;
+    }
+    job_started.notify_all();
+
+    for (thread& t : threads) {
+        t.join();
+    }
+}
+
+// takes the next task from the front of own range
+bool CThreadPool::PopTask(const uint32_t worker, uint32_t& task) {
+    atomic<uint64_t>& own = work_ranges[worker].range;
+    uint64_t r = own.load();
+
+    while (RangeBegin(r) < RangeEnd(r)) {
+        if (own.compare_exchange_weak(
+                r, PackRange(RangeBegin(r) + 1, RangeEnd(r)))) {
+            task = RangeBegin(r);
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+// moves the back half of the biggest other range into own (empty) range
+bool CThreadPool::StealTasks(const uint32_t worker) {
+    while (true) {
+        uint32_t victim = worker;
+        uint64_t victim_range = 0;
+        uint32_t victim_size = 0;
+
+        for (uint32_t i = 0; i < thread_count; i++) {
+            uint64_t r = work_ranges[i].range.load();
+            uint32_t size = RangeEnd(r) - RangeBegin(r);
+
+            if ((i != worker) && (RangeBegin(r) < RangeEnd(r)) &&
+                (size > victim_size)) {
+                victim = i;
+                victim_range = r;
+                victim_size = size;
+            }
+        }
+
+        if (victim == worker) {
+            return (false);  // nothing left anywhere
+        }
+
+        uint32_t middle = RangeEnd(victim_range) - (victim_size + 1) / 2;
+        if (work_ranges[victim].range.compare_exchange_strong(
+                victim_range, PackRange(RangeBegin(victim_range), middle))) {
+            work_ranges[worker].range =
+                PackRange(middle, RangeEnd(victim_range));
+            return (true);
+        }
+        // victim changed meanwhile, look again
+    }
+}
+
+void CThreadPool::DoTasks(const uint32_t worker) {
+    uint32_t task;
+
+    do {
+        while (PopTask(worker, task)) {
+            (*job)(worker, task);
+        }
+    } while (StealTasks(worker));
+}
+
+void CThreadPool::WorkerLoop(const uint32_t worker) {
+    uint64_t seen_generation = 0;
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(job_mutex);
+            job_started.wait(lock, [&] {
+                return (stopping || (job_generation != seen_generation));
+            });
+
+            if (stopping) {
+                return;
+            }
+            seen_generation = job_generation;
+        }
+
+        DoTasks(worker);
+
+        {
+            lock_guard<mutex> lock(job_mutex);
+            --busy_workers;
+        }
+        job_finished.notify_all();
+    }
+}
+
+void CThreadPool::Run(const uint32_t task_count,
+                      const TPoolTask& task_function) {
+    // share tasks out as contiguous ranges, one per worker
+    for (uint32_t i = 0; i < thread_count; i++) {
+        uint32_t begin = static_cast<uint64_t>(task_count) * i / thread_count;
+        uint32_t end =
+            static_cast<uint64_t>(task_count) * (i + 1) / thread_count;
+        work_ranges[i].range = PackRange(begin, end);
+    }
+
+    {
+        lock_guard<mutex> lock(job_mutex);
+        job = &task_function;
+        busy_workers = thread_count - 1;
+        ++job_generation;
+    }
+    job_started.notify_all();
+
+    DoTasks(0);
+
+    unique_lock<mutex> lock(job_mutex);
+    job_finished.wait(lock, [&] { return (busy_workers == 0); });
+    job = nullptr;
+}
@@ -0,0 +1,64 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>  // for platform independent types
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// function executed for every task, worker is the index of the executing
+// thread (0 .. NumberOfThreads() - 1) so that callers can keep per-thread
+// state without locking
+typedef function<void(const uint32_t worker, const uint32_t task)> TPoolTask;
+
+// Fixed size thread pool running indexed tasks with work-stealing.
+//
+// Run() splits the task indices into one contiguous range per worker. Each
+// worker takes tasks from the front of its own range, and when it runs dry it
+// steals the back half of the biggest other range. The calling thread works as
+// worker 0, so a pool of one thread does not start any extra thread.
+class CThreadPool {
+   private:
+    // [begin, end) of task indices packed into one word so that owner and
+    // thieves can update it with a single compare and swap
+    class CWorkRange {
+       public:
+        atomic<uint64_t> range;
+        char padding[64 - sizeof(atomic<uint64_t>)];  // avoid false sharing
+    };
+
+    vector<thread> threads;
+    unique_ptr<CWorkRange[]> work_ranges;
+    uint32_t thread_count;
+
+    mutex job_mutex;
+    condition_variable job_started;
+    condition_variable job_finished;
+    uint64_t job_generation;
+    uint32_t busy_workers;
+    bool stopping;
+    const TPoolTask* job;
+
+    bool PopTask(const uint32_t worker, uint32_t& task);
+    bool StealTasks(const uint32_t worker);
+    void DoTasks(const uint32_t worker);
+    void WorkerLoop(const uint32_t worker);
+
+   public:
+    // thread_count 0 means one thread per hardware core
+    CThreadPool(const uint32_t thread_count = 0);
+    ~CThreadPool(void);
+
+    uint32_t NumberOfThreads(void) const { return thread_count; }
+
+    // runs task_function for tasks 0 .. task_count - 1 and returns when all
+    // of them are done
+    void Run(const uint32_t task_count, const TPoolTask& task_function);
+};
+
+#endif
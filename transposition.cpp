@@ -0,0 +1,77 @@
+#include "transposition.h"
+
+static uint64_t PackStatistics(const int32_t visits, const int32_t wins) {
+    return ((static_cast<uint64_t>(static_cast<uint32_t>(visits)) << 32) |
+            static_cast<uint32_t>(wins));
+}
+
+CTranspositionTable::CTranspositionTable(const uint64_t entry_count) {
+    uint64_t buckets = 1;
+    while (buckets * 2 * BucketSize <= entry_count) {
+        buckets *= 2;
+    }
+
+    bucket_mask = buckets - 1;
+    entries.reset(new CEntry[buckets * BucketSize]);
+    Clear();
+}
+
+void CTranspositionTable::Clear() {
+    for (uint64_t i = 0; i < Size(); i++) {
+        entries[i].check.store(0, memory_order_relaxed);
+        entries[i].data.store(0, memory_order_relaxed);
+    }
+}
+
+bool CTranspositionTable::Probe(const uint64_t hash, int32_t& visits,
+                                int32_t& wins) const {
+    const CEntry* bucket = Bucket(hash);
+
+    for (uint32_t i = 0; i < BucketSize; i++) {
+        uint64_t data = bucket[i].data.load(memory_order_relaxed);
+        uint64_t check = bucket[i].check.load(memory_order_relaxed);
+
+        // empty entries have no visits, so hash 0 is never found by mistake
+        if (((check ^ data) == hash) && ((data >> 32) != 0)) {
+            visits = static_cast<int32_t>(data >> 32);
+            wins = static_cast<int32_t>(data & 0xFFFFFFFFu);
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+void CTranspositionTable::Add(const uint64_t hash, const int32_t visits,
+                              const int32_t wins) {
+    CEntry* bucket = Bucket(hash);
+    CEntry* target = &bucket[0];
+    uint64_t target_visits = ~0ull;
+    uint64_t old_data = 0;
+
+    for (uint32_t i = 0; i < BucketSize; i++) {
+        uint64_t data = bucket[i].data.load(memory_order_relaxed);
+        uint64_t check = bucket[i].check.load(memory_order_relaxed);
+
+        if (((check ^ data) == hash) && ((data >> 32) != 0)) {
+            target = &bucket[i];
+            old_data = data;
+            break;
+        }
+
+        // replacement candidate, torn entries count as the visits they show
+        if ((data >> 32) < target_visits) {
+            target_visits = data >> 32;
+            target = &bucket[i];
+        }
+    }
+
+    // visits and wins are added separately so wins can not carry into the
+    // visits word
+    uint64_t data =
+        PackStatistics(static_cast<int32_t>(old_data >> 32) + visits,
+                       static_cast<int32_t>(old_data & 0xFFFFFFFFu) + wins);
+
+    target->data.store(data, memory_order_relaxed);
+    target->check.store(hash ^ data, memory_order_relaxed);
+}
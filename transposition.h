@@ -0,0 +1,55 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <atomic>
+#include <cstdint>  // for platform independent types
+#include <memory>
+using namespace std;
+
+// Fixed size table of playout statistics by position hash, shared by all
+// searches of a game and by all threads without locks.
+//
+// Positions are found by their Zobrist hash (see CBitBoard::Hash()). Each
+// entry stores its visits and wins in one word and that word xored with
+// the hash in another, so a reader detects an entry which another thread
+// was writing at the same time and treats it as missing. Two threads adding
+// to the same entry at once may lose one of the updates, which costs a
+// playout result but never corrupts the table.
+//
+// Entries are grouped into buckets of BucketSize. A new position replaces
+// the entry of its bucket with the fewest visits, so well searched
+// positions survive.
+class CTranspositionTable {
+   public:
+    static const uint32_t BucketSize = 4;
+
+   private:
+    class CEntry {
+       public:
+        atomic<uint64_t> check;  // hash ^ data
+        atomic<uint64_t> data;   // visits << 32 | wins
+    };
+
+    unique_ptr<CEntry[]> entries;
+    uint64_t bucket_mask;
+
+    CEntry* Bucket(const uint64_t hash) const {
+        return (&entries[(hash & bucket_mask) * BucketSize]);
+    }
+
+   public:
+    // entry_count is rounded down to a power of two, at least one bucket
+    CTranspositionTable(const uint64_t entry_count = 1 << 20);
+
+    uint64_t Size(void) const { return (bucket_mask + 1) * BucketSize; }
+    void Clear(void);
+
+    // false if the position has no entry
+    bool Probe(const uint64_t hash, int32_t& visits, int32_t& wins) const;
+
+    // adds the playout results to the entry of the position, creating it
+    // if needed
+    void Add(const uint64_t hash, const int32_t visits, const int32_t wins);
+};
+
+#endif
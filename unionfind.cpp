@@ -0,0 +1,10 @@
+#include "unionfind.h"
+
+void CUnionFind::Reset(const uint32_t element_count) {
+    parent.resize(element_count);
+    rank.assign(element_count, 0);
+
+    for (uint32_t i = 0; i < element_count; i++) {
+        parent[i] = i;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef UNIONFIND_H
+#define UNIONFIND_H
+
+#include <cstdint>  // for platform independent types
+#include <vector>
+using namespace std;
+
+// Disjoint set forest with union by rank and path halving, so a sequence of
+// operations costs nearly constant time per operation.
+class CUnionFind {
+   private:
+    vector<int32_t> parent;
+    vector<uint8_t> rank;
+
+   public:
+    CUnionFind(const uint32_t element_count = 0) { Reset(element_count); }
+
+    // every element becomes its own set
+    void Reset(const uint32_t element_count);
+
+    uint32_t Size(void) const { return parent.size(); }
+
+    int32_t Find(int32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];  // path halving
+            x = parent[x];
+        }
+        return (x);
+    }
+
+    // merges sets of x and y, returns false if they were already one set
+    bool Union(const int32_t x, const int32_t y) {
+        int32_t root_x = Find(x);
+        int32_t root_y = Find(y);
+
+        if (root_x == root_y) {
+            return (false);
+        }
+
+        // attach the shorter tree below the taller one
+        if (rank[root_x] < rank[root_y]) {
+            parent[root_x] = root_y;
+        } else if (rank[root_x] > rank[root_y]) {
+            parent[root_y] = root_x;
+        } else {
+            parent[root_y] = root_x;
+            rank[root_x]++;
+        }
+
+        return (true);
+    }
+
+    bool Connected(const int32_t x, const int32_t y) {
+        return (Find(x) == Find(y));
+    }
+};
+
+#endif